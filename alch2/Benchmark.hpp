@@ -0,0 +1,50 @@
+#pragma once
+#include <alchlib2.hpp>
+
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+#include <string_view>
+
+/**
+ * @brief		Times potion evaluation methods & prints their throughput.
+ */
+struct Benchmark {
+	std::ostream& os;
+
+	/**
+	 * @brief			Gets every combination of 2 or 3 different ingredients in a registry, in lexicographic order.
+	 * @param count		The number of ingredients in the registry.
+	 * @param limit		The maximum number of recipes to return. When it's reached, the remaining combinations are skipped.
+	 */
+	static std::vector<alchlib2::Recipe> GetAllRecipes(const size_t count, const size_t limit = std::numeric_limits<size_t>::max())
+	{
+		std::vector<alchlib2::Recipe> recipes;
+		for (alchlib2::IngredientID a{ 0 }; a < count && recipes.size() < limit; ++a) {
+			for (alchlib2::IngredientID b{ a + 1 }; b < count && recipes.size() < limit; ++b) {
+				recipes.emplace_back(alchlib2::Recipe{ a, b });
+				for (alchlib2::IngredientID c{ b + 1 }; c < count && recipes.size() < limit; ++c)
+					recipes.emplace_back(alchlib2::Recipe{ a, b, c });
+			}
+		}
+		return recipes;
+	}
+
+	/**
+	 * @brief			Runs func once & prints the number of recipes it evaluated per second.
+	 * @param name		The name of the method being timed.
+	 * @param count		The number of recipes that func evaluates.
+	 * @param func		A callable that evaluates count recipes, and returns a checksum of the results so that they can't be optimized away.
+	 */
+	template<typename TFunc>
+	void Run(std::string_view name, const size_t count, TFunc&& func) const
+	{
+		const auto& start{ std::chrono::steady_clock::now() };
+		const auto checksum{ func() };
+		const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+
+		os << "  " << std::left << std::setw(24) << name << std::right
+			<< std::setw(14) << std::fixed << std::setprecision(0) << (elapsed.count() > 0.0 ? $c(double, count) / elapsed.count() : 0.0) << " recipes/s"
+			<< "  (" << count << " recipes in " << std::setprecision(1) << elapsed.count() * 1000.0 << " ms, checksum " << checksum << ")\n";
+	}
+};
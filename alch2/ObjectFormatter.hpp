@@ -45,7 +45,7 @@ struct ObjectFormatter {
 #	pragma region split_for_highlighter
 	std::tuple<std::string, std::string, std::string> split_for_highlighter(const std::string& input, const std::string& substr) const
 	{
-		const auto& startingPos{ str::tolower(input).find(str::tolower(substr)) };
+		const auto& startingPos{ alchlib2::text::find(input, substr) };
 		if (startingPos == std::string::npos) return{ input, {}, {} };
 		const auto& substrLen{ substr.length() };
 		return{ input.substr(0ull, startingPos), input.substr(startingPos, substrLen), input.substr(startingPos + substrLen) };
@@ -59,17 +59,44 @@ struct ObjectFormatter {
 		}
 		return{ input, {}, {} };
 	}
+	std::tuple<std::string, std::string, std::string> split_for_highlighter(const std::string& input, const std::optional<alchlib2::Highlight>& highlight) const
+	{
+		if (!highlight.has_value() || highlight->offset + highlight->length > input.size()) return{ input, {}, {} };
+		return{ input.substr(0ull, highlight->offset), input.substr(highlight->offset, highlight->length), input.substr(highlight->offset + highlight->length) };
+	}
 #	pragma endregion split_for_highlighter
-	bool do_highlight(std::string input, const std::string& search_term, const bool onlyHighlightExactMatch = false) const
+	bool do_highlight(const std::string& input, const std::string& search_term, const bool onlyHighlightExactMatch = false) const
 	{
-		return onlyHighlightExactMatch ? str::tolower(search_term) == str::tolower(input) : str::tolower(input).find(str::tolower(search_term)) != std::string::npos;
+		return onlyHighlightExactMatch ? alchlib2::text::equals(input, search_term) : alchlib2::text::contains(input, search_term);
 	}
-	bool do_highlight(std::string input, const std::vector<std::string>& search_terms, const bool onlyHighlightExactMatch = false) const
+	bool do_highlight(const std::string& input, const std::vector<std::string>& search_terms, const bool onlyHighlightExactMatch = false) const
 	{
-		input = str::tolower(input);
 		return std::any_of(search_terms.begin(), search_terms.end(), [&](auto&& search_term) { return do_highlight(input, search_term, onlyHighlightExactMatch); });
 	}
 
+private:
+	/**
+	 * @brief		Writes the magnitude & duration columns that follow an effect's name.
+	 *			Shared by both Effect overloads of to_string so their layouts stay identical.
+	 */
+	void write_effect_stats(std::ostream& os, const alchlib2::Effect& effect) const
+	{
+		const auto magnitudeStr{ (effect.magnitude == 0.0f || effect.magnitude == -0.0f) ? "" : str::stringify(effect.magnitude) };
+		const auto durationStr{ (effect.duration == 0) ? "" : str::stringify(effect.duration, 's') };
+		const bool printMagnitude{ !magnitudeStr.empty() };
+		const bool printDuration{ !durationStr.empty() };
+
+		if (printMagnitude || printDuration) {
+			os << shared::indent(EFFECT_MAGNITUDE_INDENT, effect.name.size());
+			if (printMagnitude)
+				os << csync(color::intense_magenta) << magnitudeStr << csync();
+			if (printDuration)
+				os << shared::indent(EFFECT_DURATION_INDENT, magnitudeStr.size()) << csync(color::cyan) << durationStr << csync();
+		}
+	}
+
+public:
+
 #	pragma region to_string
 	template<var::any_same_or_convertible<std::string, std::vector<std::string>> TSearchTerm>
 	std::string to_string(const alchlib2::Ingredient& ingredient, TSearchTerm const& search_term, const bool onlyHighlightExactMatch = false) const
@@ -91,10 +118,6 @@ struct ObjectFormatter {
 	std::string to_string(const alchlib2::Effect& effect, TSearchTerm const& search_term, const bool onlyHighlightExactMatch = false) const
 	{
 		const auto& disposition{ effect.GetDisposition() };
-		const auto magnitudeStr{ (effect.magnitude == 0.0f || effect.magnitude == -0.0f) ? "" : str::stringify(effect.magnitude) };
-		const auto durationStr{ (effect.duration == 0) ? "" : str::stringify(effect.duration, 's') };
-		const bool printMagnitude{ !magnitudeStr.empty() };
-		const bool printDuration{ !durationStr.empty() };
 		std::stringstream ss;
 
 		if (onlyHighlightExactMatch) {
@@ -112,13 +135,27 @@ struct ObjectFormatter {
 				ss << keywordColors(disposition) << effect.name << keywordColors();
 		}
 
-		if (printMagnitude || printDuration) {
-			ss << shared::indent(EFFECT_MAGNITUDE_INDENT, effect.name.size());
-			if (printMagnitude)
-				ss << csync(color::intense_magenta) << magnitudeStr << csync();
-			if (printDuration)
-				ss << shared::indent(EFFECT_DURATION_INDENT, magnitudeStr.size()) << csync(color::cyan) << durationStr << csync();
-		}
+		write_effect_stats(ss, effect);
+
+		return ss.str();
+	}
+	std::string to_string(const alchlib2::Ingredient& ingredient, const std::optional<alchlib2::Highlight>& highlight) const
+	{
+		if (const auto& [pre, highlighted, post] { split_for_highlighter(ingredient.name, highlight) }; highlight.has_value())
+			return str::stringify(csync(color::bold), pre, csync(searchTermHighlightColor), highlighted, csync(color::reset), post, csync(color::no_bold));
+		return str::stringify(csync(color::bold), ingredient.name, csync());
+	}
+	std::string to_string(const alchlib2::Effect& effect, const std::optional<alchlib2::Highlight>& highlight) const
+	{
+		const auto& disposition{ effect.GetDisposition() };
+		std::stringstream ss;
+
+		if (const auto& [pre, highlighted, post] { split_for_highlighter(effect.name, highlight) }; highlight.has_value())
+			ss << keywordColors(disposition) << pre << keywordColors() << csync(searchTermHighlightColor) << highlighted << csync() << keywordColors(disposition) << post << keywordColors();
+		else
+			ss << keywordColors(disposition) << effect.name << keywordColors();
+
+		write_effect_stats(ss, effect);
 
 		return ss.str();
 	}
@@ -164,5 +201,23 @@ struct ObjectFormatter {
 		}
 		return os;
 	}
+	/// @brief	Prints an ingredient using highlights from a previous search, rather than searching its names again.
+	std::ostream& print(std::ostream& os, const alchlib2::Ingredient& ingredient, const alchlib2::IngredientHighlights& highlights)
+	{
+		os << shared::indent(INGREDIENT_INDENT) << to_string(ingredient, highlights.name);
+		for (size_t i{ 0 }; i < ingredient.effects.size(); ++i) {
+			const auto& effect{ ingredient.effects[i] };
+			const auto& highlight{ i < highlights.effects.size() ? highlights.effects[i] : std::nullopt };
+			if (quiet && !highlight.has_value())
+				continue;
+			os << '\n' << shared::indent(EFFECT_INDENT) << to_string(effect, highlight);
+			if (all) {
+				for (const auto& keyword : effect.keywords) {
+					os << '\n' << shared::indent(KEYWORD_INDENT) << keywordColors(keyword.disposition) << keyword.name << keywordColors();
+				}
+			}
+		}
+		return os;
+	}
 #	pragma endregion print
 };
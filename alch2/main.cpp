@@ -2,6 +2,7 @@
 #include "copyright.h"
 
 #include "ObjectFormatter.hpp"
+#include "Benchmark.hpp"
 
 #include <alchlib2.hpp>
 #include <opt3.hpp>
@@ -33,13 +34,67 @@ struct help {
 			<< "  -e, --exact         Match whole search terms rather than allowing any result that contains the search term." << '\n'
 			<< "  -i, --ingr <PATH>   Override the default search path for the ingredients registry." << '\n'
 			<< "  -g, --gmst <PATH>   Override the default search path for the game settings config. This only applies to build mode." << '\n'
+			<< "      --explain       Shows the compiled plan before the results. This only applies to query mode." << '\n'
+			<< "      --min-mag <#>   Only show ingredients where a matched effect has at least this magnitude. Applies to search, smart & keyword modes." << '\n'
+			<< "      --max-mag <#>   Only show ingredients where a matched effect has at most this magnitude. Applies to search, smart & keyword modes." << '\n'
+			<< "      --min-dur <#>   Only show ingredients where a matched effect has at least this duration. Applies to search, smart & keyword modes." << '\n'
+			<< "      --max-dur <#>   Only show ingredients where a matched effect has at most this duration. Applies to search, smart & keyword modes." << '\n'
+			<< "      --max-ingr <#>  The maximum number of ingredients per recipe, from 2 to 4. Defaults to 3. Applies to enumerate, solve, plan, reverse & recipes-db modes." << '\n'
+			<< "      --threads <#>   The number of threads to use. Defaults to one per hardware thread. Applies to enumerate, solve & recipes-db modes." << '\n'
+			<< "                       Solve mode defaults to one thread when '--cache' is specified, since the cache isn't shared between threads." << '\n'
+			<< "      --optional <E>  Prefer recipes with effects matching <E>, without requiring them. Can be repeated. This only applies to solve mode." << '\n'
+			<< "      --forbid <E>    Exclude recipes with effects matching <E>. Can be repeated. This only applies to solve mode." << '\n'
+			<< "      --no-harmful    Exclude recipes with harmful effects. This only applies to solve mode." << '\n'
+			<< "      --by <OBJ>      What to maximize: magnitude, duration, value or purity. Defaults to magnitude. Applies to enumerate, solve & recipes-db modes." << '\n'
+			<< "                       With '--pareto', this can be a comma-separated list of objectives to compare instead." << '\n'
+			<< "      --top <#>       The maximum number of recipes to show. Defaults to 10. Applies to enumerate, solve & recipes-db modes." << '\n'
+			<< "                       In enumerate mode, this only shows the best recipes according to '--by' instead of every recipe." << '\n'
+			<< "      --target <E>    Maximize the number of potions with the effect matching <E>, instead of their value. This only applies to plan mode." << '\n'
+			<< "      --cache <PATH>  Reuse potions that were evaluated by earlier runs, & save new ones to <PATH>. Applies to build & solve modes." << '\n'
+			<< "      --cache-size <#>" << '\n'
+			<< "                      The maximum number of potions to keep in the cache. Defaults to 65536." << '\n'
+			<< "      --csv           Prints sweep mode's table as CSV." << '\n'
+			<< "      --pareto        Only show recipes that no other recipe beats for every objective, as one JSON object per line." << '\n'
+			<< "                       Compares magnitude, duration & value, plus purity in solve mode, unless '--by' is specified." << '\n'
+			<< "                       This only applies to enumerate & solve modes." << '\n'
+			<< "      --optimal       Search for the best possible plan. This can be very slow for large inventories. This only applies to plan mode." << '\n'
+			<< "      --sig-index <PATH>" << '\n'
+			<< "                      Read the recipe index of reverse mode from <PATH>, or build it & save it there if it's missing or out of date." << '\n'
+			<< "      --db <PATH>     The path of the recipe database. Defaults to 'alch.recipes'. This only applies to recipes-db mode." << '\n'
 			//< continue [OPTIONS] here
 			<< '\n'
 			<< "MODES:\n"
 			<< "  -l, --list          Lists all ingredients present in the registry. This mode does not accept any inputs." << '\n'
 			<< "  -s, --search        Search for ingredients or effects. Requires at least one <INPUT>." << '\n'
 			<< "  -S, --smart         Search for ingredients that have effects matching all of the given <INPUTS>." << '\n'
+			<< "  -k, --keyword       Search for ingredients that have effects with a keyword name or formID matching the given <INPUTS>." << '\n'
+			<< "  -Q, --query         Search for ingredients matching a boolean query made up of all <INPUTS>. Example:" << '\n'
+			<< "                       effect:\"Restore Health\" AND NOT keyword:MagicAlchHarmful AND mag>=5" << '\n'
+			<< "                      Terms:  name:<VALUE>, effect:<VALUE>, keyword:<VALUE>, <VALUE>, mag <OP> <NUMBER>, dur <OP> <NUMBER>" << '\n'
+			<< "                      Stats can be limited to one effect, like:  mag(\"Fortify Smithing\")>=3" << '\n'
+			<< "                      Use '=' instead of ':' for exact matches. Combine terms with AND, OR, NOT & parentheses." << '\n'
+			<< "                      Quote the whole query so the shell doesn't remove the quotes around values containing spaces." << '\n'
+			<< "  -C, --combine       Lists ingredients that share at least one effect with each of the ingredients named by <INPUTS>." << '\n'
 			<< "  -B, --build         " << '\n'
+			<< "      --bench         Measures how many recipes per second can be evaluated, using every combination of 2 or 3 ingredients." << '\n'
+			<< "      --enumerate     Lists every potion that can be made from the registry, where each ingredient shares an effect with another." << '\n'
+			<< "                      Potions are printed in order of their ingredients as soon as they're evaluated. This mode does not accept any inputs." << '\n'
+			<< "                      Ingredients with identical effects are only evaluated once in this mode & solve mode; recipes that only differ by" << '\n'
+			<< "                       those ingredients are printed together & count as one recipe for '--top'." << '\n'
+			<< "      --solve         Finds the best recipes that have an effect matching each of the given <INPUTS>. Requires at least one <INPUT>," << '\n'
+			<< "                       unless '--optional' is specified. Example:  --solve \"Fortify Smithing\" --optional \"Fortify Enchanting\" --no-harmful" << '\n'
+			<< "      --plan          Plans which potions to brew from the inventory file given by <INPUT>, without running out of ingredients." << '\n'
+			<< "                      Inventory files contain a JSON object of ingredient names & counts. Example:  { \"Wheat\": 5, \"Blisterwort\": 3 }" << '\n'
+			<< "      --sweep <AXIS>  Shows how the potion made from the ingredients given by <INPUTS> changes over a range of a game setting." << '\n'
+			<< "                      Example:  --sweep fAlchemyAV=15..100 \"Blue Mountain Flower\" Wheat    Add ':<STEP>' to change the step size." << '\n'
+			<< "      --reverse       Lists every recipe that produces exactly the potion given by <INPUTS>, which is either a potion name like" << '\n'
+			<< "                       \"Elixir of Fortify Restoration\", a potion JSON file, or the potion's effects. Recipes are grouped by their effects." << '\n'
+			<< "      --recipes-db <COMMAND>" << '\n'
+			<< "                      Builds or queries a file of every recipe for the registry & game settings. Commands:" << '\n'
+			<< "                       build           Evaluates every recipe on '--threads' threads & saves them to the database. When the database" << '\n'
+			<< "                                        already exists, only the recipes of added or modified ingredients are evaluated." << '\n'
+			<< "                       best <EFFECTS>  Shows the best recipes that have every effect matching <INPUTS>, using '--top' & '--by'." << '\n'
+			<< "                       exact <EFFECTS> Lists every recipe that has exactly the effects matching <INPUTS>, from the most valuable." << '\n'
 			//< continue [MODES] here
 			;
 	}
@@ -51,7 +106,27 @@ enum Mode : std::uint8_t {
 	Search,
 	/// @brief	Searches for ingredients that have ALL of the specified names
 	SmartSearch,
+	/// @brief	Searches for ingredients with effects that have the specified keywords
+	KeywordSearch,
+	/// @brief	Searches for ingredients matching a boolean query
+	Query,
+	/// @brief	Lists ingredients that are compatible with the specified ingredients
+	Combine,
 	Build,
+	/// @brief	Measures potion evaluation throughput
+	Bench,
+	/// @brief	Lists every useful recipe in the registry
+	Enumerate,
+	/// @brief	Finds the best recipes for a set of effects
+	Solve,
+	/// @brief	Plans a brewing session for an inventory
+	Plan,
+	/// @brief	Evaluates a recipe over a range of game setting values
+	Sweep,
+	/// @brief	Finds every recipe that produces a potion
+	Reverse,
+	/// @brief	Builds or queries a precomputed recipe database
+	RecipesDb,
 };
 
 int main(const int argc, char** argv)
@@ -61,6 +136,23 @@ int main(const int argc, char** argv)
 			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, 'i', "ingr"),
 			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, 'g', "gmst"),
 			opt3::make_template(opt3::CaptureStyle::Disabled, opt3::ConflictStyle::Conflict, 'l', "list"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "min-mag"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "max-mag"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "min-dur"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "max-dur"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "max-ingr"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "threads"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "optional"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "forbid"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "by"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "top"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "target"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "cache"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "cache-size"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "sweep"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "sig-index"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "recipes-db"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "db"),
 		};
 		const auto& [programPath, programName] { env::PATH{}.resolve_split(argv[0]) };
 
@@ -89,6 +181,121 @@ int main(const int argc, char** argv)
 
 			alchlib2::Registry registry{ alchlib2::Registry::ReadFrom(registryPath) };
 
+			// the registry index is only built by modes that need it
+			std::optional<alchlib2::RegistryIndex> registryIndex;
+			const auto& getIndex{ [&registry, &registryIndex]() -> const alchlib2::RegistryIndex& {
+				if (!registryIndex.has_value())
+					registryIndex.emplace(registry);
+				return registryIndex.value();
+			} };
+
+			// ingredients with identical effects are grouped into classes, so searches only evaluate one recipe for each potion
+			std::optional<alchlib2::IngredientClasses> ingredientClasses;
+			const auto& getClasses{ [&getIndex, &ingredientClasses]() -> const alchlib2::IngredientClasses* {
+				if (!ingredientClasses.has_value())
+					ingredientClasses.emplace(getIndex());
+				return ingredientClasses->IsTrivial() ? nullptr : &ingredientClasses.value();
+			} };
+			// calls a function with every recipe that's equivalent to a recipe from a search that used getClasses
+			const auto& forEachEquivalent{ [&ingredientClasses](const alchlib2::Recipe& recipe, const auto& onRecipe) {
+				if (ingredientClasses.has_value() && !ingredientClasses->IsTrivial())
+					ingredientClasses->ForEachEquivalent(recipe, onRecipe);
+				else onRecipe(recipe);
+			} };
+
+			// retrieve the game settings config; this is only used by modes that build potions
+			const auto& getGameSettings{ [&args]() {
+				alchlib2::AlchemyCoreGameSettings coreGameSettings{};
+				if (const auto gameSettingsConfigPath{ args.castgetv_any<std::filesystem::path, opt3::Flag, opt3::Option>('g', "gmst").value_or("alch.gmst") };
+					file::exists(gameSettingsConfigPath))
+					coreGameSettings = alchlib2::AlchemyCoreGameSettings::ReadFrom(gameSettingsConfigPath);
+				return coreGameSettings;
+			} };
+
+			// retrieve the magnitude & duration range filters:
+			const auto& getFloatOption{ [&args](const std::string& name) -> std::optional<float> {
+				std::optional<float> value;
+				for (const auto& opt : args.get_all<opt3::Option>(name)) {
+					if (!opt.has_capture())
+						throw make_exception("Option '--", name, "' requires a number!");
+					try {
+						value = std::stof(opt.capture());
+					} catch (const std::exception&) {
+						throw make_exception("Invalid number '", opt.capture(), "' specified for option '--", name, "'!");
+					}
+				}
+				return value;
+			} };
+			const auto& getUnsignedOption{ [&args](const std::string& name) -> std::optional<unsigned> {
+				std::optional<unsigned> value;
+				for (const auto& opt : args.get_all<opt3::Option>(name)) {
+					if (!opt.has_capture())
+						throw make_exception("Option '--", name, "' requires a number!");
+					if (opt.capture().empty() || !std::all_of(opt.capture().begin(), opt.capture().end(), [](auto&& c) { return c >= '0' && c <= '9'; }))
+						throw make_exception("Invalid number '", opt.capture(), "' specified for option '--", name, "'!");
+					try {
+						value = $c(unsigned, std::stoul(opt.capture()));
+					} catch (const std::exception&) {
+						throw make_exception("Invalid number '", opt.capture(), "' specified for option '--", name, "'!");
+					}
+				}
+				return value;
+			} };
+			alchlib2::StatRange magnitudeRange, durationRange;
+			if (const auto& v{ getFloatOption("min-mag") }; v.has_value()) magnitudeRange.min = v.value();
+			if (const auto& v{ getFloatOption("max-mag") }; v.has_value()) magnitudeRange.max = v.value();
+			if (const auto& v{ getFloatOption("min-dur") }; v.has_value()) durationRange.min = v.value();
+			if (const auto& v{ getFloatOption("max-dur") }; v.has_value()) durationRange.max = v.value();
+			const bool useRanges{ !magnitudeRange.IsUnbounded() || !durationRange.IsUnbounded() };
+
+			// the potion cache is only read by modes that use it, & saved after they finish
+			const auto& cachePath{ args.castgetv_any<std::filesystem::path, opt3::Option>("cache") };
+			std::optional<alchlib2::PotionCache> potionCache;
+			const auto& getCache{ [&]() -> alchlib2::PotionCache* {
+				if (!cachePath.has_value())
+					return nullptr;
+				if (!potionCache.has_value())
+					potionCache.emplace(alchlib2::PotionCache::ReadFrom(cachePath.value(), getIndex(), getUnsignedOption("cache-size").value_or(65536u)));
+				return &potionCache.value();
+			} };
+
+			// retrieve the objectives of pareto frontier searches:
+			const bool pareto{ args.check<opt3::Option>("pareto") };
+			const auto& getParetoObjectives{ [&args](const bool withPurity) {
+				std::vector<alchlib2::ESolverObjective> objectives;
+				if (const auto& by{ args.getv_any<opt3::Option>("by") }; by.has_value()) {
+					for (size_t pos{ 0 }; pos <= by.value().size(); ) {
+						const auto& end{ std::min(by.value().find(',', pos), by.value().size()) };
+						const auto& objective{ alchlib2::get_solver_objective(by.value().substr(pos, end - pos)) };
+						if (std::ranges::find(objectives, objective) != objectives.end())
+							throw make_exception("Objective '", alchlib2::get_solver_objective_name(objective), "' was specified more than once!");
+						objectives.emplace_back(objective);
+						pos = end + 1;
+					}
+				}
+				else {
+					objectives = { alchlib2::ESolverObjective::Magnitude, alchlib2::ESolverObjective::Duration, alchlib2::ESolverObjective::Value };
+					if (withPurity)
+						objectives.emplace_back(alchlib2::ESolverObjective::Purity);
+				}
+				return objectives;
+			} };
+			// prints each recipe on a frontier as a single line of JSON, so it can be streamed to other tools
+			const auto& printFrontier{ [&registry, &forEachEquivalent](const alchlib2::ParetoFrontier& frontier, const std::vector<alchlib2::ESolverObjective>& objectives) {
+				for (const auto& [potion, scores] : frontier.GetPoints()) {
+					nlohmann::json j;
+					j["name"] = potion.GetName();
+					for (size_t d{ 0 }; d < objectives.size(); ++d)
+						j[alchlib2::get_solver_objective_name(objectives[d])] = scores[d];
+					forEachEquivalent(potion.GetRecipe(), [&](const alchlib2::Recipe& recipe) {
+						j["ingredients"] = nlohmann::json::array();
+						for (const auto& id : recipe.GetIngredients())
+							j["ingredients"].push_back(registry.Ingredients[id].name);
+						std::cout << j.dump() << '\n';
+					});
+				}
+			} };
+
 			// Find which exclusive mode the user specified
 			Mode mode{ Mode::None };
 
@@ -103,8 +310,28 @@ int main(const int argc, char** argv)
 				trySetMode(Mode::Search);
 			else if (args.check_any<opt3::Flag, opt3::Option>('S', "smart"))
 				trySetMode(Mode::SmartSearch);
+			else if (args.check_any<opt3::Flag, opt3::Option>('k', "keyword"))
+				trySetMode(Mode::KeywordSearch);
+			else if (args.check_any<opt3::Flag, opt3::Option>('Q', "query"))
+				trySetMode(Mode::Query);
+			else if (args.check_any<opt3::Flag, opt3::Option>('C', "combine"))
+				trySetMode(Mode::Combine);
 			else if (args.check_any<opt3::Flag, opt3::Option>('B', "build"))
 				trySetMode(Mode::Build);
+			else if (args.check<opt3::Option>("bench"))
+				trySetMode(Mode::Bench);
+			else if (args.check<opt3::Option>("enumerate"))
+				trySetMode(Mode::Enumerate);
+			else if (args.check<opt3::Option>("solve"))
+				trySetMode(Mode::Solve);
+			else if (args.check<opt3::Option>("plan"))
+				trySetMode(Mode::Plan);
+			else if (args.check<opt3::Option>("sweep"))
+				trySetMode(Mode::Sweep);
+			else if (args.check<opt3::Option>("reverse"))
+				trySetMode(Mode::Reverse);
+			else if (args.check<opt3::Option>("recipes-db"))
+				trySetMode(Mode::RecipesDb);
 			else // user specified multiple modes:
 				throw make_exception("No mode was specified!");
 
@@ -113,6 +340,59 @@ int main(const int argc, char** argv)
 
 			ObjectFormatter fmt{ color::setcolor::yellow, quiet, all };
 
+			// finds the effect that matches a name, which must match exactly one effect
+			const auto& findEffect{ [&getIndex, &exact](const std::string& name) {
+				const auto& index{ getIndex() };
+				if (const auto& id{ index.FindEffect(name) }; id.has_value())
+					return id.value();
+				const auto& ids{ index.FindEffects(name, exact) };
+				if (ids.empty())
+					throw make_exception("Couldn't find an effect matching \"", name, "\"!");
+				if (ids.size() > 1) {
+					std::string matches;
+					for (const auto& id : ids) {
+						if (!matches.empty()) matches += ", ";
+						matches += '"' + index.GetEffectName(id) + '"';
+					}
+					throw make_exception("\"", name, "\" matches more than one effect: ", matches, "!");
+				}
+				return ids.front();
+			} };
+
+			// prints solver results from best to worst, with their effects when '--all' is specified
+			const auto& printResults{ [&](const std::vector<alchlib2::SolverResult>& results) {
+				if (results.empty())
+					std::cout << csync(color::red) << "No recipes were found." << csync() << '\n';
+				for (size_t rank{ 0 }; rank < results.size(); ++rank) {
+					const auto& [potion, score] { results[rank] };
+					// equivalent recipes make the same potion, so they share a rank
+					forEachEquivalent(potion.GetRecipe(), [&](const alchlib2::Recipe& recipe) {
+						std::cout << (rank + 1) << ". ";
+						bool fst{ true };
+						for (const auto& id : recipe.GetIngredients()) {
+							if (fst) fst = false;
+							else std::cout << " + ";
+							std::cout << registry.Ingredients[id].name;
+						}
+						std::cout << " = " << csync(color::bold) << potion.GetName() << csync(color::no_bold) << " (score " << score;
+						if (const auto& value{ alchlib2::get_potion_value(potion) }; value > 0)
+							std::cout << ", " << csync(color::yellow) << value << csync() << " gold";
+						std::cout << ")\n";
+					});
+
+					if (all) {
+						std::cout << csync(color::red) << '{' << csync() << '\n';
+						bool fst{ true };
+						for (const auto& effect : potion.Materialize().effects) {
+							if (fst) fst = false;
+							else std::cout << '\n';
+							fmt.print(std::cout, effect);
+						}
+						std::cout << '\n' << csync(color::red) << '}' << csync() << '\n';
+					}
+				}
+			} };
+
 			// Execute mode-specific operations
 			switch (mode) {
 			case Mode::List: {
@@ -144,17 +424,24 @@ int main(const int argc, char** argv)
 				if (params.empty())
 					throw make_exception("Not enough search terms were specified for search mode. (Min 1)");
 
-				for (const auto& name : params) {
-					const auto results{ registry.copy_inclusive_filter(name, exact, true, true) };
+				// search for every term in a single pass over the registry
+				const auto& index{ getIndex() };
+				const alchlib2::MultiSearch search{ index, params, exact };
+
+				for (size_t term{ 0 }; term < search.size(); ++term) {
+					const auto& name{ search.GetTerm(term) };
+					auto results{ search.GetResults(term) };
+					if (useRanges)
+						results &= index.SelectInRange(search.GetMatchedEffects(term), magnitudeRange, durationRange);
 
 					std::cout << "Showing results for: \"" << csync(fmt.searchTermHighlightColor) << name << csync() << "\"\n"
 						<< csync(color::red) << '{' << csync() << '\n';
 
 					bool fst{ true };
-					for (const auto& ingr : results.Ingredients) {
+					for (auto it{ results.begin() }, end{ results.end() }; it != end; ++it) {
 						if (fst) fst = false;
 						else std::cout << '\n';
-						fmt.print(std::cout, ingr, name, exact);
+						fmt.print(std::cout, *it, search.GetHighlights(term, it.id()));
 					}
 
 					std::cout << "\n" << csync(color::red) << '}' << csync() << '\n';
@@ -174,12 +461,17 @@ int main(const int argc, char** argv)
 				}
 				std::cout << '\n' << csync(color::red) << '{' << csync() << '\n';
 
-				const auto results{ registry.copy_if([&params, &exact](alchlib2::Ingredient const& ingredient) {
+				auto results{ registry.select_if([&params, &exact](alchlib2::Ingredient const& ingredient) {
 					return std::all_of(params.begin(), params.end(), [&ingredient, &exact](auto&& name) { return ingredient.AnyEffectIsSimilarTo(name, exact); });
 				}) };
+				if (useRanges) {
+					const auto& index{ getIndex() };
+					for (const auto& name : params)
+						results &= index.SelectInRange(index.FindEffects(name, exact), magnitudeRange, durationRange);
+				}
 
 				fst = true;
-				for (const auto& ingr : results.Ingredients) {
+				for (const auto& ingr : results) {
 					if (fst) fst = false;
 					else std::cout << '\n';
 					fmt.print(std::cout, ingr, params, exact);
@@ -188,27 +480,167 @@ int main(const int argc, char** argv)
 				std::cout << '\n' << csync(color::red) << '}' << csync() << '\n';
 				break;
 			}
+			case Mode::KeywordSearch: {
+				if (params.empty())
+					throw make_exception("Not enough keywords were specified for keyword search mode. (Min 1)");
+
+				const auto& index{ getIndex() };
+
+				for (const auto& name : params) {
+					const auto effectIDs{ index.FindEffectsWithKeyword(name, exact) };
+
+					// highlight the effects that have a matching keyword
+					std::vector<std::string> effectNames;
+					effectNames.reserve(effectIDs.size());
+					for (const auto& effectID : effectIDs)
+						effectNames.emplace_back(index.GetEffectName(effectID));
+
+					std::cout << "Showing results for: \"" << csync(fmt.searchTermHighlightColor) << name << csync() << "\"\n"
+						<< csync(color::red) << '{' << csync() << '\n';
+
+					bool fst{ true };
+					for (const auto& ingr : index.SelectInRange(effectIDs, magnitudeRange, durationRange)) {
+						if (fst) fst = false;
+						else std::cout << '\n';
+						fmt.print(std::cout, ingr, effectNames, true);
+					}
+
+					std::cout << "\n" << csync(color::red) << '}' << csync() << '\n';
+				}
+				break;
+			}
+			case Mode::Query: {
+				if (params.empty())
+					throw make_exception("No query was specified for query mode.");
+
+				std::string queryString;
+				for (const auto& param : params) {
+					if (!queryString.empty()) queryString += ' ';
+					queryString += param;
+				}
+
+				const auto query{ alchlib2::Query::Parse(queryString, exact) };
+				const alchlib2::QueryPlan plan{ query, getIndex() };
+
+				if (args.check<opt3::Option>("explain"))
+					std::cout << "Query plan:" << '\n' << plan << '\n';
+
+				const auto effectNames{ plan.GetMatchedEffectNames() };
+
+				std::cout << "Showing results for: \"" << csync(fmt.searchTermHighlightColor) << queryString << csync() << "\"\n"
+					<< csync(color::red) << '{' << csync() << '\n';
+
+				bool fst{ true };
+				for (const auto& ingr : plan.Execute()) {
+					if (fst) fst = false;
+					else std::cout << '\n';
+					fmt.print(std::cout, ingr, effectNames, true);
+				}
+
+				std::cout << "\n" << csync(color::red) << '}' << csync() << '\n';
+				break;
+			}
+			case Mode::Combine: {
+				if (params.empty())
+					throw make_exception("Not enough ingredients were specified for combine mode. (Min 1)");
+
+				const auto& index{ getIndex() };
+				const alchlib2::CompatibilityMatrix matrix{ index };
+
+				std::vector<alchlib2::IngredientID> ingredients;
+				for (const auto& name : params) {
+					const auto& it{ registry.find_best_fit(name, true, false) };
+					if (it == registry.Ingredients.end())
+						throw make_exception("Couldn't find an ingredient matching \"", name, "\"!");
+					ingredients.emplace_back($c(alchlib2::IngredientID, std::distance(registry.Ingredients.cbegin(), it)));
+				}
+
+				alchlib2::ResultSet results{ registry.Ingredients, true };
+				for (const auto& id : ingredients)
+					results &= matrix.GetCompatible(id);
+				for (const auto& id : ingredients)
+					results.erase(id);
+
+				std::cout << "Showing ingredients that combine with: ";
+				bool fst{ true };
+				for (const auto& id : ingredients) {
+					if (fst) fst = false;
+					else std::cout << ", ";
+					std::cout << '\"' << csync(fmt.searchTermHighlightColor) << registry.Ingredients[id].name << csync() << '\"';
+				}
+				std::cout << '\n' << csync(color::red) << '{' << csync() << '\n';
+
+				fst = true;
+				for (auto it{ results.begin() }, end{ results.end() }; it != end; ++it) {
+					if (fst) fst = false;
+					else std::cout << '\n';
+					// highlight the effects that are shared with any of the specified ingredients
+					std::uint8_t sharedSlots{ 0 };
+					for (const auto& id : ingredients)
+						sharedSlots |= matrix.Get(id, it.id()) >> 4;
+					alchlib2::IngredientHighlights highlights;
+					for (size_t slot{ 0 }; slot < it->effects.size(); ++slot) {
+						if ((sharedSlots >> slot) & 1)
+							highlights.effects.emplace_back(alchlib2::Highlight{ 0u, $c(std::uint32_t, it->effects[slot].name.size()) });
+						else highlights.effects.emplace_back(std::nullopt);
+					}
+					fmt.print(std::cout, *it, highlights);
+				}
+
+				std::cout << "\n" << csync(color::red) << '}' << csync() << '\n';
+				break;
+			}
 			case Mode::Build: {
 				if (params.size() < 2)
 					throw make_exception("Not enough ingredients were specified for build mode. (Min 2)");
 				
-				// retrieve the game settings config:
-				alchlib2::AlchemyCoreGameSettings coreGameSettings{};
+				const auto coreGameSettings{ getGameSettings() };
 
-				if (const auto gameSettingsConfigPath{ args.castgetv_any<std::filesystem::path, opt3::Flag, opt3::Option>('g', "gmst").value_or("alch.gmst") };
-					file::exists(gameSettingsConfigPath))
-					coreGameSettings = alchlib2::AlchemyCoreGameSettings::ReadFrom(gameSettingsConfigPath);
+				// collect all the ingredients, in the order they were given; terms that match the same ingredient only use it once
+				std::vector<alchlib2::IngredientID> ids;
+				std::vector<alchlib2::Ingredient> ingredients;
+				for (const auto& param : params) {
+					if (const auto& it{ registry.find_best_fit(param, true, false) }; it != registry.Ingredients.end()) {
+						const auto id{ $c(alchlib2::IngredientID, std::distance(registry.Ingredients.cbegin(), it)) };
+						if (std::ranges::find(ids, id) != ids.end())
+							continue;
+						ids.emplace_back(id);
+						ingredients.emplace_back(*it);
+					}
+				}
+				if (ids.size() < 2)
+					throw make_exception("Not enough ingredients were specified for build mode. (Min 2)");
+				if (ids.size() > alchlib2::MAX_POTION_INGREDIENTS)
+					throw make_exception("Too many ingredients were specified for build mode. (Max ", alchlib2::MAX_POTION_INGREDIENTS, ")");
+
+				// the potion is built from the ingredients in ascending ID order, which is the order that PotionCache evaluates recipes in,
+				//  so the effect order & the name of the potion are the same with or without --cache
+				auto sortedIDs{ ids };
+				std::ranges::sort(sortedIDs);
 
-				// collect all the ingredients:
-				const auto& results{ registry.find_best_fit(params, true, false) };
 				alchlib2::PotionBuilder builder{ coreGameSettings };
 				alchlib2::perks::VanillaPerks vanillaPerks{};
-				const auto potion{ builder.Build(results.Ingredients, vanillaPerks.GetAllPerks()) };
+				const auto potion{ [&]() {
+					auto* cache{ getCache() };
+					if (cache == nullptr) {
+						std::vector<alchlib2::Ingredient> sorted;
+						sorted.reserve(sortedIDs.size());
+						for (const auto& id : sortedIDs)
+							sorted.emplace_back(registry.Ingredients[id]);
+						return builder.Build(sorted, vanillaPerks.GetPipeline());
+					}
+
+					alchlib2::Recipe recipe;
+					for (const auto& id : sortedIDs)
+						recipe.ingredients[recipe.count++] = id;
+					const alchlib2::PotionCalculator calculator{ coreGameSettings, vanillaPerks };
+					return cache->Evaluate(builder, calculator, recipe).Materialize();
+				}() };
 
 				// print input ingredients:
 				std::cout << "Combining ingredients:" << '\n' << csync(color::red) << '{' << csync() << '\n';
 				bool fst{ true };
-				for (const auto& ingr : results.Ingredients) {
+				for (const auto& ingr : ingredients) {
 					if (fst) fst = false;
 					else std::cout << '\n';
 					fmt.print(std::cout, ingr, params, exact);
@@ -217,6 +649,8 @@ int main(const int argc, char** argv)
 
 				// print potion name & alchemy stats
 				std::cout << "Produces: \"" << csync(color::bold) << potion.name << csync(color::no_bold) << "\"\n";
+				if (const auto& value{ alchlib2::get_potion_value(potion) }; value > 0)
+					std::cout << "Worth:    " << csync(color::yellow) << value << csync() << " gold\n";
 				if (all) {
 					std::cout
 						<< csync(color::gray) << "With alchemy stats:" << '\n'
@@ -236,6 +670,512 @@ int main(const int argc, char** argv)
 
 				break;
 			}
+			case Mode::Bench: {
+				const auto& index{ getIndex() };
+				const auto coreGameSettings{ getGameSettings() };
+				const alchlib2::PotionBuilder builder{ coreGameSettings };
+				const std::vector<alchlib2::Perk> noPerks;
+
+				const auto& recipes{ Benchmark::GetAllRecipes(registry.size()) };
+				// building Potion objects is much slower, so only a sample is used
+				const auto sampleSize{ std::min(recipes.size(), size_t{ 100000 }) };
+
+				std::cout << "Evaluating " << recipes.size() << " recipes from " << registry.size() << " ingredients:\n";
+				const Benchmark benchmark{ std::cout };
+
+				benchmark.Run("Build", sampleSize, [&]() {
+					size_t checksum{ 0 };
+					for (size_t i{ 0 }; i < sampleSize; ++i)
+						checksum += builder.Build(index, recipes[i].GetIngredients(), noPerks).effects.size();
+					return checksum;
+				});
+
+				// compare the dynamic & static perk paths with every vanilla perk enabled
+				alchlib2::perks::VanillaPerks vanillaPerks{};
+				vanillaPerks.Alchemist.enable = vanillaPerks.Physician.enable = vanillaPerks.Benefactor.enable = vanillaPerks.Poisoner.enable = vanillaPerks.Purity.enable = true;
+				vanillaPerks.Alchemist.rank = 5;
+				const auto& dynamicPerks{ vanillaPerks.GetAllPerks() };
+				const auto& staticPerks{ vanillaPerks.GetPipeline() };
+
+				benchmark.Run("Build (dynamic perks)", sampleSize, [&]() {
+					size_t checksum{ 0 };
+					for (size_t i{ 0 }; i < sampleSize; ++i)
+						checksum += builder.Build(index, recipes[i].GetIngredients(), dynamicPerks).effects.size();
+					return checksum;
+				});
+				benchmark.Run("Build (static perks)", sampleSize, [&]() {
+					size_t checksum{ 0 };
+					for (size_t i{ 0 }; i < sampleSize; ++i)
+						checksum += builder.Build(index, recipes[i].GetIngredients(), staticPerks).effects.size();
+					return checksum;
+				});
+
+				const alchlib2::PotionCalculator calculator{ coreGameSettings, vanillaPerks };
+				benchmark.Run("Evaluate (calculator)", sampleSize, [&]() {
+					size_t checksum{ 0 };
+					for (size_t i{ 0 }; i < sampleSize; ++i)
+						checksum += builder.Evaluate(index, recipes[i], calculator).GetEffectCount();
+					return checksum;
+				});
+
+				alchlib2::PotionBatch batch{ index };
+				benchmark.Run("BuildMany", recipes.size(), [&]() {
+					constexpr size_t BATCH_SIZE{ 4096 };
+					size_t checksum{ 0 };
+					for (size_t first{ 0 }; first < recipes.size(); first += BATCH_SIZE) {
+						builder.BuildMany(std::span{ recipes }.subspan(first, std::min(BATCH_SIZE, recipes.size() - first)), batch);
+						for (size_t i{ 0 }; i < batch.size(); ++i)
+							checksum += batch.GetEffectCount(i);
+					}
+					return checksum;
+				});
+
+				benchmark.Run("BuildMany (calculator)", recipes.size(), [&]() {
+					constexpr size_t BATCH_SIZE{ 4096 };
+					size_t checksum{ 0 };
+					for (size_t first{ 0 }; first < recipes.size(); first += BATCH_SIZE) {
+						builder.BuildMany(std::span{ recipes }.subspan(first, std::min(BATCH_SIZE, recipes.size() - first)), batch, calculator);
+						for (size_t i{ 0 }; i < batch.size(); ++i)
+							checksum += batch.GetEffectCount(i);
+					}
+					return checksum;
+				});
+				std::vector<unsigned> values;
+				benchmark.Run("Value (calculator)", recipes.size(), [&]() {
+					constexpr size_t BATCH_SIZE{ 4096 };
+					unsigned best{ 0 };
+					for (size_t first{ 0 }; first < recipes.size(); first += BATCH_SIZE) {
+						builder.BuildMany(std::span{ recipes }.subspan(first, std::min(BATCH_SIZE, recipes.size() - first)), batch, calculator);
+						alchlib2::get_potion_values(batch, values);
+						best = std::max(best, *std::max_element(values.begin(), values.end()));
+					}
+					return best;
+				});
+				break;
+			}
+			case Mode::Enumerate: {
+				const auto& index{ getIndex() };
+				const auto coreGameSettings{ getGameSettings() };
+				const alchlib2::PotionBuilder builder{ coreGameSettings };
+				const alchlib2::PotionCalculator calculator{ coreGameSettings };
+
+				const auto& start{ std::chrono::steady_clock::now() };
+				const alchlib2::CompatibilityMatrix matrix{ index };
+
+				if (pareto) {
+					// every effect is wanted, so purity would always be the same as magnitude
+					const auto& objectives{ getParetoObjectives(false) };
+					alchlib2::SolverQuery query;
+					query.maxIngredients = getUnsignedOption("max-ingr").value_or(3u);
+					query.classes = getClasses();
+					const alchlib2::RecipeSolver solver{ matrix, builder, calculator };
+					const auto& frontier{ solver.SolveFrontier(query, objectives, getUnsignedOption("threads").value_or(0u)) };
+					printFrontier(frontier, objectives);
+
+					if (!quiet) {
+						const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+						std::cerr << "Found " << frontier.size() << " pareto-optimal potions in " << std::fixed << std::setprecision(2) << elapsed.count() << " seconds." << std::endl;
+					}
+					break;
+				}
+				if (const auto& top{ getUnsignedOption("top") }; top.has_value()) {
+					// only the best recipes are kept, so the solver can prune every branch that can't beat them
+					alchlib2::SolverQuery query;
+					query.maxIngredients = getUnsignedOption("max-ingr").value_or(3u);
+					query.count = top.value();
+					query.classes = getClasses();
+					if (const auto& objective{ args.getv_any<opt3::Option>("by") }; objective.has_value())
+						query.objective = alchlib2::get_solver_objective(objective.value());
+					const alchlib2::RecipeSolver solver{ matrix, builder, calculator };
+					const auto& results{ solver.Solve(query, getUnsignedOption("threads").value_or(0u)) };
+					printResults(results);
+
+					if (!quiet) {
+						const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+						std::cerr << "Found the top " << results.size() << " potions in " << std::fixed << std::setprecision(2) << elapsed.count() << " seconds." << std::endl;
+					}
+					break;
+				}
+
+				// only one recipe is evaluated for each set of equivalent recipes, which are printed together
+				const auto maxIngredients{ getUnsignedOption("max-ingr").value_or(3u) };
+				const auto* classes{ getClasses() };
+				const auto& enumerator{ classes == nullptr ? alchlib2::RecipeEnumerator{ matrix, 2, maxIngredients } : alchlib2::RecipeEnumerator{ matrix, classes->GetCandidates(maxIngredients), 2, maxIngredients } };
+
+				size_t count{ 0 };
+				std::string line;
+				enumerator.Run(builder, calculator, [&](const alchlib2::PotionBatch& batch) {
+					for (size_t i{ 0 }; i < batch.size(); ++i) {
+						if (!batch.IsValid(i) || (classes != nullptr && !classes->IsCanonical(batch.GetRecipe(i)))) continue;
+						const auto& name{ batch.GetName(i) };
+						const auto& value{ alchlib2::get_potion_value(index.GetBaseCosts(), batch.GetEffectIDs(i), batch.GetMagnitudes(i), batch.GetDurations(i)) };
+						forEachEquivalent(batch.GetRecipe(i), [&](const alchlib2::Recipe& recipe) {
+							line.clear();
+							for (const auto& id : recipe.GetIngredients()) {
+								if (!line.empty()) line += " + ";
+								line += registry.Ingredients[id].name;
+							}
+							std::cout << line << " = " << csync(color::bold) << name << csync(color::no_bold);
+							if (value > 0)
+								std::cout << " (" << csync(color::yellow) << value << csync() << " gold)";
+							std::cout << '\n';
+							++count;
+						});
+					}
+				}, getUnsignedOption("threads").value_or(0u));
+
+				if (!quiet) {
+					const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+					std::cerr << "Enumerated " << count << " potions in " << std::fixed << std::setprecision(2) << elapsed.count() << " seconds." << std::endl;
+				}
+				break;
+			}
+			case Mode::Solve: {
+				const auto& index{ getIndex() };
+				const auto coreGameSettings{ getGameSettings() };
+				const alchlib2::PotionBuilder builder{ coreGameSettings };
+				const alchlib2::PotionCalculator calculator{ coreGameSettings };
+
+				// required effects must each match exactly one effect, while optional & forbidden ones include every match
+				const auto& findEffects{ [&index, &exact](const std::string& name) {
+					const auto& ids{ index.FindEffects(name, exact) };
+					if (ids.empty())
+						throw make_exception("Couldn't find an effect matching \"", name, "\"!");
+					return ids;
+				} };
+
+				alchlib2::SolverQuery query;
+				for (const auto& name : params)
+					query.required.emplace_back(findEffect(name));
+				for (const auto& opt : args.get_all<opt3::Option>("optional")) {
+					const auto& ids{ findEffects(opt.capture()) };
+					query.optional.insert(query.optional.end(), ids.begin(), ids.end());
+				}
+				for (const auto& opt : args.get_all<opt3::Option>("forbid")) {
+					const auto& ids{ findEffects(opt.capture()) };
+					query.forbidden.insert(query.forbidden.end(), ids.begin(), ids.end());
+				}
+				if (query.required.empty() && query.optional.empty())
+					throw make_exception("Not enough effects were specified for solve mode. (Min 1)");
+				query.excludeHarmful = args.check<opt3::Option>("no-harmful");
+				query.maxIngredients = getUnsignedOption("max-ingr").value_or(3u);
+				query.classes = getClasses();
+
+				const alchlib2::CompatibilityMatrix matrix{ index };
+				const alchlib2::RecipeSolver solver{ matrix, builder, calculator, getCache() };
+
+				if (pareto) {
+					const auto& objectives{ getParetoObjectives(true) };
+					printFrontier(solver.SolveFrontier(query, objectives), objectives);
+					break;
+				}
+
+				if (const auto& objective{ args.getv_any<opt3::Option>("by") }; objective.has_value())
+					query.objective = alchlib2::get_solver_objective(objective.value());
+				query.count = getUnsignedOption("top").value_or(10u);
+				// the cache isn't shared between threads, so searches that use it default to one thread
+				const auto& results{ solver.Solve(query, getUnsignedOption("threads").value_or(cachePath.has_value() ? 1u : 0u)) };
+
+				printResults(results);
+				break;
+			}
+			case Mode::Plan: {
+				if (params.size() != 1)
+					throw make_exception("Plan mode requires exactly one inventory file!");
+				const auto& index{ getIndex() };
+				const auto coreGameSettings{ getGameSettings() };
+				const alchlib2::PotionBuilder builder{ coreGameSettings };
+				const alchlib2::PotionCalculator calculator{ coreGameSettings };
+				const auto& inventory{ alchlib2::Inventory::ReadFrom(params.front(), registry) };
+
+				alchlib2::PlannerQuery query;
+				if (const auto& target{ args.getv_any<opt3::Option>("target") }; target.has_value()) {
+					const auto& ids{ index.FindEffects(target.value(), exact) };
+					if (ids.empty())
+						throw make_exception("Couldn't find an effect matching \"", target.value(), "\"!");
+					if (ids.size() > 1)
+						throw make_exception("\"", target.value(), "\" matches more than one effect!");
+					query.objective = alchlib2::EPlanObjective::EffectCount;
+					query.targetEffect = ids.front();
+				}
+				query.maxIngredients = getUnsignedOption("max-ingr").value_or(3u);
+
+				const alchlib2::CompatibilityMatrix matrix{ index };
+				const alchlib2::BrewingPlanner planner{ matrix, builder, calculator };
+				const auto& plan{ args.check<opt3::Option>("optimal") ? planner.PlanExact(inventory, query) : planner.Plan(inventory, query) };
+
+				if (plan.steps.empty())
+					std::cout << csync(color::red) << "No potions can be made from this inventory." << csync() << '\n';
+				unsigned potions{ 0 };
+				for (const auto& [potion, count, score] : plan.steps) {
+					std::cout << count << "x ";
+					bool fst{ true };
+					for (const auto& id : potion.GetRecipe().GetIngredients()) {
+						if (fst) fst = false;
+						else std::cout << " + ";
+						std::cout << registry.Ingredients[id].name;
+					}
+					std::cout << " = " << csync(color::bold) << potion.GetName() << csync(color::no_bold);
+					if (query.objective == alchlib2::EPlanObjective::Value)
+						std::cout << " (" << csync(color::yellow) << score << csync() << " gold each)";
+					std::cout << '\n';
+					potions += count;
+				}
+				if (!quiet) {
+					std::cout << "Total: " << potions << " potions";
+					if (query.objective == alchlib2::EPlanObjective::Value)
+						std::cout << " worth " << csync(color::yellow) << plan.total << csync() << " gold";
+					if (args.check<opt3::Option>("optimal") && !plan.optimal)
+						std::cout << " (the search was stopped early, so this might not be the best plan)";
+					std::cout << '\n';
+				}
+				break;
+			}
+			case Mode::Sweep: {
+				if (params.size() < 2)
+					throw make_exception("Not enough ingredients were specified for sweep mode. (Min 2)");
+				const auto& axisArg{ args.getv_any<opt3::Option>("sweep") };
+				if (!axisArg.has_value())
+					throw make_exception("Option '--sweep' requires a game setting & range, like fAlchemyAV=15..100!");
+
+				if (params.size() > alchlib2::MAX_POTION_INGREDIENTS)
+					throw make_exception("Sweep mode requires 2 to ", alchlib2::MAX_POTION_INGREDIENTS, " different ingredients!");
+
+				const auto& index{ getIndex() };
+				// resolve the ingredients in the order they were given; a term that doesn't match, or matches an ingredient that was already given, is an error
+				alchlib2::Recipe recipe;
+				for (const auto& param : params) {
+					const auto& it{ registry.find_best_fit(param, true, false) };
+					if (it == registry.Ingredients.end())
+						throw make_exception("No ingredient matches '", param, "'!");
+					const auto id{ $c(alchlib2::IngredientID, std::distance(registry.Ingredients.cbegin(), it)) };
+					if (const auto& given{ recipe.GetIngredients() }; std::ranges::find(given, id) != given.end())
+						throw make_exception("Ingredient '", it->name, "' was specified more than once!");
+					recipe.ingredients[recipe.count++] = id;
+				}
+
+				const alchlib2::PotionSweep sweep{ alchlib2::SweepAxis::Parse(axisArg.value()), getGameSettings() };
+				const auto& result{ sweep.Evaluate(index, recipe) };
+				const auto effectIDs{ result.GetEffectIDs() };
+
+				// each row has the setting, the potion's name, the magnitude & duration of each effect, & the potion's value
+				std::vector<std::vector<std::string>> rows;
+				auto& header{ rows.emplace_back() };
+				header.emplace_back(sweep.GetAxis().setting);
+				header.emplace_back("Potion");
+				for (const auto& id : effectIDs) {
+					header.emplace_back(index.GetEffect(id).name + " Magnitude");
+					header.emplace_back(index.GetEffect(id).name + " Duration");
+				}
+				header.emplace_back("Value");
+				for (size_t k{ 0 }; k < result.size(); ++k) {
+					const auto& potion{ result.GetPotion(k) };
+					auto& row{ rows.emplace_back() };
+					row.emplace_back(str::stringify(sweep.GetValues()[k]));
+					row.emplace_back(potion.GetName());
+					for (size_t e{ 0 }; e < effectIDs.size(); ++e) {
+						row.emplace_back(result.HasEffect(e, k) ? str::stringify(result.GetMagnitudes(e)[k]) : "");
+						row.emplace_back(result.HasEffect(e, k) ? str::stringify(result.GetDurations(e)[k]) : "");
+					}
+					row.emplace_back(str::stringify(alchlib2::get_potion_value(potion)));
+				}
+
+				if (args.check<opt3::Option>("csv")) {
+					for (const auto& row : rows) {
+						for (size_t c{ 0 }; c < row.size(); ++c) {
+							if (c > 0) std::cout << ',';
+							if (row[c].find_first_of(",\"") != std::string::npos) {
+								std::string quoted{ row[c] };
+								for (size_t pos{ quoted.find('"') }; pos != std::string::npos; pos = quoted.find('"', pos + 2))
+									quoted.insert(pos, 1, '"');
+								std::cout << '"' << quoted << '"';
+							}
+							else std::cout << row[c];
+						}
+						std::cout << '\n';
+					}
+					break;
+				}
+
+				std::vector<size_t> widths(header.size(), 0);
+				for (const auto& row : rows)
+					for (size_t c{ 0 }; c < row.size(); ++c)
+						widths[c] = std::max(widths[c], row[c].size());
+				for (size_t r{ 0 }; r < rows.size(); ++r) {
+					for (size_t c{ 0 }; c < rows[r].size(); ++c) {
+						if (c > 0) std::cout << "  ";
+						if (r == 0) std::cout << csync(color::bold);
+						std::cout << rows[r][c] << std::string(widths[c] - rows[r][c].size(), ' ');
+						if (r == 0) std::cout << csync(color::no_bold);
+					}
+					std::cout << '\n';
+				}
+				break;
+			}
+			case Mode::Reverse: {
+				if (params.empty())
+					throw make_exception("Reverse mode requires a potion name, a potion file, or at least one effect!");
+				const auto& index{ getIndex() };
+				const auto coreGameSettings{ getGameSettings() };
+				const alchlib2::PotionBuilder builder{ coreGameSettings };
+				const alchlib2::PotionCalculator calculator{ coreGameSettings };
+				const auto maxIngredients{ getUnsignedOption("max-ingr").value_or(3u) };
+
+				const auto& start{ std::chrono::steady_clock::now() };
+
+				// the signature index is read from '--sig-index' when it's up to date, & otherwise built & saved there
+				const auto& sigIndexPath{ args.castgetv_any<std::filesystem::path, opt3::Option>("sig-index") };
+				std::optional<alchlib2::SignatureIndex> signatureIndex;
+				if (sigIndexPath.has_value())
+					signatureIndex = alchlib2::SignatureIndex::ReadFrom(sigIndexPath.value(), index, maxIngredients);
+				if (!signatureIndex.has_value()) {
+					signatureIndex.emplace(alchlib2::CompatibilityMatrix{ index }, maxIngredients);
+					if (sigIndexPath.has_value() && !alchlib2::SignatureIndex::WriteTo(sigIndexPath.value(), index, signatureIndex.value()))
+						throw make_exception("Failed to write the signature index to ", sigIndexPath.value(), "!");
+				}
+
+				// the target is a potion file, a potion name like "Elixir of Fortify Restoration", or a list of effects
+				std::vector<alchlib2::EffectSignature> signatures;
+				std::optional<std::string> targetName;
+				const auto& lower{ str::tolower(params.front()) };
+				const bool isPotionName{ params.size() == 1 && std::ranges::any_of(std::array<std::string_view, 4>{ "potion of ", "draught of ", "elixir of ", "poison of " }, [&lower](auto&& prefix) { return lower.starts_with(prefix); }) };
+				if (params.size() == 1 && file::exists(params.front())) {
+					nlohmann::json j;
+					file::read(params.front()) >> j;
+					std::vector<alchlib2::EffectID> ids;
+					for (const auto& effect : j.get<alchlib2::Potion>().effects) {
+						const auto& id{ index.FindEffect(effect.name) };
+						if (!id.has_value())
+							throw make_exception("Potion file ", params.front(), " has an effect that isn't in the registry: \"", effect.name, "\"!");
+						ids.emplace_back(id.value());
+					}
+					signatures.emplace_back(ids);
+				}
+				else if (isPotionName) {
+					// names only depend on the strongest effect & the number of effects, so every signature with the effect is
+					//  a candidate, & the names of their potions are checked below
+					const auto& prefix{ lower.substr(0, lower.find(' ')) };
+					const auto& id{ findEffect(params.front().substr(lower.find(" of ") + 4)) };
+					for (const auto& signature : signatureIndex->GetSignatures()) {
+						if (!signature.Contains(id)
+							|| (prefix == "potion" && signature.size() != 1)
+							|| (prefix == "draught" && signature.size() != 2)
+							|| (prefix == "elixir" && signature.size() <= 2))
+							continue;
+						signatures.emplace_back(signature);
+					}
+					targetName = lower;
+				}
+				else {
+					std::vector<alchlib2::EffectID> ids;
+					for (const auto& name : params)
+						ids.emplace_back(findEffect(name));
+					signatures.emplace_back(ids);
+				}
+
+				size_t count{ 0 };
+				for (const auto& signature : signatures) {
+					bool first{ true };
+					for (const auto& recipe : signatureIndex->Find(signature)) {
+						const auto& potion{ builder.Evaluate(index, recipe, calculator) };
+						if (targetName.has_value() && str::tolower(potion.GetName()) != targetName.value())
+							continue;
+						if (first) {
+							// show the signature before its first recipe
+							first = false;
+							std::cout << csync(color::red) << '[' << csync();
+							for (size_t e{ 0 }; e < signature.size(); ++e) {
+								if (e > 0) std::cout << ", ";
+								std::cout << index.GetEffectName(signature.GetEffectIDs()[e]);
+							}
+							std::cout << csync(color::red) << ']' << csync() << '\n';
+						}
+						std::cout << "  ";
+						bool fst{ true };
+						for (const auto& id : recipe.GetIngredients()) {
+							if (fst) fst = false;
+							else std::cout << " + ";
+							std::cout << registry.Ingredients[id].name;
+						}
+						std::cout << " = " << csync(color::bold) << potion.GetName() << csync(color::no_bold);
+						if (const auto& value{ alchlib2::get_potion_value(potion) }; value > 0)
+							std::cout << " (" << csync(color::yellow) << value << csync() << " gold)";
+						std::cout << '\n';
+						++count;
+					}
+				}
+				if (count == 0)
+					std::cout << csync(color::red) << "No recipes were found." << csync() << '\n';
+
+				if (!quiet) {
+					const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+					std::cerr << "Found " << count << " recipes in " << std::fixed << std::setprecision(2) << elapsed.count() << " seconds, using an index of " << signatureIndex->GetRecipeCount() << " recipes." << std::endl;
+				}
+				break;
+			}
+			case Mode::RecipesDb: {
+				const auto& command{ str::tolower(args.getv_any<opt3::Option>("recipes-db").value_or("")) };
+				const auto& dbPath{ args.castgetv_any<std::filesystem::path, opt3::Option>("db").value_or("alch.recipes") };
+				const auto& index{ getIndex() };
+				const auto coreGameSettings{ getGameSettings() };
+				const alchlib2::PotionCalculator calculator{ coreGameSettings };
+				const auto& start{ std::chrono::steady_clock::now() };
+
+				if (command == "build") {
+					const alchlib2::PotionBuilder builder{ coreGameSettings };
+					const alchlib2::CompatibilityMatrix matrix{ index };
+					// an existing database only needs the recipes of the ingredients that changed since it was built
+					const auto& [count, reused, changed] { alchlib2::RecipeDatabase::Update(dbPath, matrix, builder, calculator, getUnsignedOption("max-ingr").value_or(3u), getUnsignedOption("threads").value_or(0u)) };
+					if (!quiet) {
+						const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+						std::cerr << "Saved " << count << " recipes to " << dbPath << " in " << std::fixed << std::setprecision(2) << elapsed.count() << " seconds.";
+						if (reused > 0)
+							std::cerr << " (Reused " << reused << " recipes; " << changed << " ingredients changed)";
+						std::cerr << std::endl;
+					}
+					break;
+				}
+				if (command != "best" && command != "exact")
+					throw make_exception("Invalid recipes-db command '", command, "'! (Expected build, best or exact)");
+				if (params.empty())
+					throw make_exception("Not enough effects were specified for recipes-db mode. (Min 1)");
+				if (!file::exists(dbPath))
+					throw make_exception("Couldn't find a recipe database at ", dbPath, "! (Create it with '--recipes-db build')");
+
+				const alchlib2::RecipeDatabase db{ dbPath };
+				if (!db.IsCurrent(index, calculator))
+					throw make_exception("The recipe database at ", dbPath, " was built for a different registry or game settings! (Rebuild it with '--recipes-db build')");
+				std::vector<alchlib2::EffectID> effectIDs;
+				for (const auto& name : params)
+					effectIDs.emplace_back(findEffect(name));
+
+				std::vector<alchlib2::SolverResult> results;
+				if (command == "best") {
+					const auto objective{ alchlib2::get_solver_objective(args.getv_any<opt3::Option>("by").value_or("magnitude")) };
+					for (const auto& [record, score] : db.FindBest(effectIDs, objective, getUnsignedOption("top").value_or(10u)))
+						results.emplace_back(alchlib2::SolverResult{ alchlib2::RecipeDatabase::GetPotion(index, *record), score });
+				}
+				else {
+					// recipes with exactly the same effects only differ by their stats, so they're ranked by value
+					for (const auto& record : db.Find(alchlib2::EffectSignature{ effectIDs }))
+						results.emplace_back(alchlib2::SolverResult{ alchlib2::RecipeDatabase::GetPotion(index, record), $c(float, record.value) });
+					std::ranges::stable_sort(results, std::greater<>{}, &alchlib2::SolverResult::score);
+				}
+				printResults(results);
+
+				if (!quiet) {
+					const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+					std::cerr << "Found " << results.size() << " of " << db.size() << " recipes in " << std::fixed << std::setprecision(2) << elapsed.count() << " seconds." << std::endl;
+				}
+				break;
+			}
+			}
+
+			if (potionCache.has_value()) {
+				if (!alchlib2::PotionCache::WriteTo(cachePath.value(), potionCache.value()))
+					throw make_exception("Failed to write the potion cache to ", cachePath.value(), "!");
+				if (!quiet)
+					std::cerr << "Potion cache: " << potionCache->GetHits() << " hits, " << potionCache->GetMisses() << " misses, " << potionCache->size() << " potions saved." << std::endl;
 			}
 		}
 
@@ -6,6 +6,7 @@
 #include <str.hpp>
 #include <fileio.hpp>
 
+#include <array>
 #include <cmath>
 #include <utility>
 
@@ -100,6 +101,55 @@ namespace caco_alch {
 		}
 	};
 
+	/**
+	 * @struct CompiledGameConfig
+	 * @brief Typed copy of the values in a GameConfig, with the potion formula reduced to one multiplier per effect class.
+	 *		  This is rebuilt whenever the GameConfig changes, so calculating potions never looks up settings by name.
+	 */
+	struct CompiledGameConfig {
+		double fAlchemyIngredientInitMult;
+		double fAlchemySkillFactor;
+		unsigned fAlchemyAV;
+		double fAlchemyMod;
+		unsigned fPerkAlchemyMasteryRank;
+		double fPerkPoisonerFactor;
+		bool bPerkPoisoner;
+		bool bPerkPureMixture;
+		bool bPerkBenefactor;
+		bool bPerkAdvancedLab;
+		bool bPerkThatWhichDoesNotKillYou;
+		_internal::PerkPhysicianType sPerkPhysicianType;
+
+		/**
+		 * @brief Combined multiplier of the base formula & perks, indexed by get_effect_class().
+		 */
+		std::array<double, 4> _multipliers;
+
+		/**
+		 * @function get_effect_class(const Effect&)
+		 * @brief Get the index of the multiplier that applies to a given effect.
+		 *		  Bit 0 is set for beneficial effects (Benefactor), bit 1 for effects that are only harmful (Poisoner).
+		 * @param effect	- The effect to classify.
+		 * @returns size_t
+		 */
+		[[nodiscard]] static size_t get_effect_class(const Effect& effect)
+		{
+			const bool beneficial{ effect.hasKeyword(Keywords::KYWD_Beneficial) };
+			return static_cast<size_t>(beneficial) | (static_cast<size_t>(!beneficial && effect.hasKeyword(Keywords::KYWD_Harmful)) << 1u);
+		}
+
+		/**
+		 * @function get_multiplier(const Effect&) const
+		 * @brief Get the combined base formula & perk multiplier for a given effect.
+		 * @param effect	- Target effect.
+		 * @returns double
+		 */
+		[[nodiscard]] double get_multiplier(const Effect& effect) const
+		{
+			return _multipliers[get_effect_class(effect)];
+		}
+	};
+
 	/**
 	 * @struct GameConfig
 	 * @brief Contains values parsed from the INI config used in potion building.
@@ -107,7 +157,8 @@ namespace caco_alch {
 	struct GameConfig {
 		using Cont = std::vector<GameConfigBase>;
 	private:
-		Cont _settings; ///< @brief Game Setting Container.
+		Cont _settings; ///< @brief Game Setting Container. This is only used for reading, writing & setting values by name.
+		CompiledGameConfig _compiled; ///< @brief Typed snapshot of _settings, used by the getters & potion calculations.
 
 		/**
 		 * @function find(const std::string&)
@@ -129,14 +180,14 @@ namespace caco_alch {
 		 * @brief Copy-Move Constructor
 		 * @param settings	- A settings object to import.
 		 */
-		explicit GameConfig(Cont settings) : _settings{ std::move(settings) } {}
+		explicit GameConfig(Cont settings) : _settings{ std::move(settings) }, _compiled{ compile() } {}
 		/**
 		 * @constructor GameConfig(Cont, const std::string&)
 		 * @brief Default Constructor, reads values from a given file
 		 * @param default_settings	- The default settings used to fill in any missing entries.
 		 * @param filename			- The filepath to read settings from.
 		 */
-		explicit GameConfig(Cont default_settings, const std::string& filename) : _settings{ set(std::move(default_settings), file::read(filename)) } {}
+		explicit GameConfig(Cont default_settings, const std::string& filename) : _settings{ set(std::move(default_settings), file::read(filename)) }, _compiled{ compile() } {}
 
 	#pragma region GENERIC_GETTERS_SETTERS
 		/**
@@ -176,10 +227,10 @@ namespace caco_alch {
 		[[nodiscard]] bool getBoolValue(const std::string& name, const int off = 0) const
 		{
 			try {
-				return std::get<GameConfigBase::BOOL>(find(name, off)->_value).value();
-			} catch (std::exception&) {
-				throw make_exception(std::string("Failed to retrieve \'" + name + '\'').c_str());
-			}
+				if (const auto it{ find(name, off) }; it != _settings.end())
+					return std::get<GameConfigBase::BOOL>(it->_value).value();
+			} catch (std::exception&) {}
+			throw make_exception(std::string("Failed to retrieve \'" + name + '\'').c_str());
 		}
 		/**
 		 * @function getDoubleValue(const std::string&, const int = 0) const
@@ -190,10 +241,10 @@ namespace caco_alch {
 		[[nodiscard]] double getDoubleValue(const std::string& name, const int off = 0) const
 		{
 			try {
-				return std::get<GameConfigBase::DOUBLE>(find(name, off)->_value).value();
-			} catch (std::exception&) {
-				throw make_exception(std::string("Failed to retrieve \'" + name + '\'').c_str());
-			}
+				if (const auto it{ find(name, off) }; it != _settings.end())
+					return std::get<GameConfigBase::DOUBLE>(it->_value).value();
+			} catch (std::exception&) {}
+			throw make_exception(std::string("Failed to retrieve \'" + name + '\'').c_str());
 		}
 		/**
 		 * @function getStringValue(const std::string&, const int = 0) const
@@ -204,10 +255,10 @@ namespace caco_alch {
 		[[nodiscard]] std::string getStringValue(const std::string& name, const int off = 0) const
 		{
 			try {
-				return std::get<GameConfigBase::STRING>(find(name, off)->_value).value();
-			} catch (std::exception&) {
-				throw make_exception(std::string("Failed to retrieve \'" + name + '\'').c_str());
-			}
+				if (const auto it{ find(name, off) }; it != _settings.end())
+					return std::get<GameConfigBase::STRING>(it->_value).value();
+			} catch (std::exception&) {}
+			throw make_exception(std::string("Failed to retrieve \'" + name + '\'').c_str());
 		}
 
 		/**
@@ -275,7 +326,10 @@ namespace caco_alch {
 		 */
 		bool set(const std::string& setting, const std::string& value_str)
 		{
-			return set(std::find_if(_settings.begin(), _settings.end(), [&setting](const Cont::value_type& e) { return e._name == setting; }), _settings.end(), value_str);
+			if (!set(std::find_if(_settings.begin(), _settings.end(), [&setting](const Cont::value_type& e) { return e._name == setting; }), _settings.end(), value_str))
+				return false;
+			_compiled = compile();
+			return true;
 		}
 
 		/**
@@ -286,25 +340,109 @@ namespace caco_alch {
 		void read_ini(const std::string& filename)
 		{
 			_settings = set(_settings, file::read(filename));
+			_compiled = compile();
 		}
 	#pragma endregion GENERIC_GETTERS_SETTERS
 
+	#pragma region COMPILE
+	private:
+		/**
+		 * @function parse_physician_type(const std::string&)
+		 * @brief Convert the value of sPerkPhysicianType to the corresponding enum.
+		 * @param value	- The string value of the setting.
+		 * @returns _internal::PerkPhysicianType
+		 */
+		[[nodiscard]] static _internal::PerkPhysicianType parse_physician_type(const std::string& value)
+		{
+			using namespace _internal;
+			const auto str{ str::tolower(value) };
+			if (str::pos_valid(str.find("health")))
+				return PerkPhysicianType::HEALTH;
+			if (str::pos_valid(str.find("stamina")))
+				return PerkPhysicianType::STAMINA;
+			if (str::pos_valid(str.find("magicka")))
+				return PerkPhysicianType::MAGICKA;
+			if (str::pos_valid(str.find("beneficial")) || str::pos_valid(str.find("all")))
+				return PerkPhysicianType::ALL;
+			return PerkPhysicianType::NONE;
+		}
+		/**
+		 * @function compile() const
+		 * @brief Retrieve every game setting by name, & precompute the base formula & perk multipliers.
+		 *		  This must be called again whenever _settings is modified.
+		 * @returns CompiledGameConfig
+		 */
+		[[nodiscard]] CompiledGameConfig compile() const
+		{
+			CompiledGameConfig c{};
+			c.fAlchemyIngredientInitMult = getDoubleValue("fAlchemyIngredientInitMult");
+			c.fAlchemySkillFactor = getDoubleValue("fAlchemySkillFactor");
+			c.fAlchemyAV = static_cast<unsigned>(std::round(getDoubleValue("fAlchemyAV")));
+			c.fAlchemyMod = getDoubleValue("fAlchemyMod");
+			c.fPerkAlchemyMasteryRank = static_cast<unsigned>(std::round(std::clamp(getDoubleValue("fPerkAlchemyMasteryRank"), 0.0, 2.0)));
+			c.fPerkPoisonerFactor = getDoubleValue("fPerkPoisonerFactor");
+			c.bPerkPoisoner = getBoolValue("bPerkPoisoner");
+			c.bPerkPureMixture = getBoolValue("bPerkPureMixture");
+			c.bPerkBenefactor = getBoolValue("bPerkBenefactor");
+			c.bPerkAdvancedLab = getBoolValue("bPerkAdvancedLab");
+			c.bPerkThatWhichDoesNotKillYou = getBoolValue("bPerkThatWhichDoesNotKillYou");
+			c.sPerkPhysicianType = parse_physician_type(getStringValue("sPerkPhysicianType"));
+
+			// base formula
+			const auto AVAlchemy{ static_cast<double>(c.fAlchemyAV) };
+			double base{ c.fAlchemyIngredientInitMult
+				* (1.0 + AVAlchemy / 200.0)
+				* (1.0 + (c.fAlchemySkillFactor - 1.0))
+				* (AVAlchemy / 100.0)
+				* (1.0 + c.fAlchemyMod / 100.0) };
+			// perks that apply to every effect
+			if (c.fPerkAlchemyMasteryRank == 1u)
+				base *= 1.2;
+			else if (c.fPerkAlchemyMasteryRank == 2u)
+				base *= 1.4;
+			if (c.bPerkAdvancedLab)
+				base *= 1.25;
+			if (c.bPerkThatWhichDoesNotKillYou)
+				base *= 1.25;
+			// perks that depend on the effect class
+			for (size_t i{ 0u }; i < c._multipliers.size(); ++i) {
+				auto mult{ base };
+				if (c.bPerkBenefactor && (i & 1u) != 0u)
+					mult *= 1.25;
+				if (c.bPerkPoisoner && (i & 2u) != 0u)
+					mult *= 1.0 + AVAlchemy * c.fPerkPoisonerFactor;
+				c._multipliers[i] = mult;
+			}
+			return c;
+		}
+	#pragma endregion COMPILE
+
+	public:
 	#pragma region GMST_GETTERS
+		/**
+		 * @function compiled() const
+		 * @brief Retrieve the typed snapshot of the current game settings.
+		 * @returns const CompiledGameConfig&
+		 */
+		[[nodiscard]] const CompiledGameConfig& compiled() const
+		{
+			return _compiled;
+		}
 		[[nodiscard]] double fAlchemyIngredientInitMult() const
 		{
-			return getDoubleValue("fAlchemyIngredientInitMult");
+			return _compiled.fAlchemyIngredientInitMult;
 		}
 		[[nodiscard]] double fAlchemySkillFactor() const
 		{
-			return getDoubleValue("fAlchemySkillFactor");
+			return _compiled.fAlchemySkillFactor;
 		}
 		[[nodiscard]] unsigned fAlchemyAV() const
 		{
-			return static_cast<unsigned>(std::round(getDoubleValue("fAlchemyAV")));
+			return _compiled.fAlchemyAV;
 		}
 		[[nodiscard]] double fAlchemyMod() const
 		{
-			return getDoubleValue("fAlchemyMod");
+			return _compiled.fAlchemyMod;
 		}
 		/**
 		 * @function fPerkAlchemyMasteryRank() const
@@ -313,46 +451,31 @@ namespace caco_alch {
 		 */
 		[[nodiscard]] unsigned fPerkAlchemyMasteryRank() const
 		{
-			auto val{ getDoubleValue("fPerkAlchemyMasteryRank") };
-			if (val > 2.0)
-				val = 2.0;
-			else if (val < 0.0)
-				val = 0.0;
-			return static_cast<unsigned>(std::round(val));
+			return _compiled.fPerkAlchemyMasteryRank;
 		}
 		[[nodiscard]] bool bPerkPoisoner() const
 		{
-			return getBoolValue("bPerkPoisoner");
+			return _compiled.bPerkPoisoner;
 		}
 		[[nodiscard]] bool bPerkAdvancedLab() const
 		{
-			return getBoolValue("bPerkAdvancedLab");
+			return _compiled.bPerkAdvancedLab;
 		}
 		[[nodiscard]] bool bPerkThatWhichDoesNotKillYou() const
 		{
-			return getBoolValue("bPerkThatWhichDoesNotKillYou");
+			return _compiled.bPerkThatWhichDoesNotKillYou;
 		}
 		[[nodiscard]] bool bPerkBenefactor() const
 		{
-			return getBoolValue("bPerkBenefactor");
+			return _compiled.bPerkBenefactor;
 		}
 		[[nodiscard]] double fPerkPoisonerFactor() const
 		{
-			return getDoubleValue("fPerkPoisonerFactor");
+			return _compiled.fPerkPoisonerFactor;
 		}
 		[[nodiscard]] _internal::PerkPhysicianType sPerkPhysicianType() const
 		{
-			using namespace _internal;
-			const auto str{ str::tolower(getStringValue("sPerkPhysicianType")) };
-			if (str::pos_valid(str.find("health")))
-				return PerkPhysicianType::HEALTH;
-			if (str::pos_valid(str.find("stamina")))
-				return PerkPhysicianType::STAMINA;
-			if (str::pos_valid(str.find("magicka")))
-				return PerkPhysicianType::MAGICKA;
-			if (str::pos_valid(str.find("beneficial")) || str::pos_valid(str.find("all")))
-				return PerkPhysicianType::ALL;
-			return PerkPhysicianType::NONE;
+			return _compiled.sPerkPhysicianType;
 		}
 		/**
 		 * @function bPerkPhysicianAppliesTo(const Effect&) const
@@ -379,40 +502,10 @@ namespace caco_alch {
 		}
 		[[nodiscard]] bool bPerkPureMixture() const
 		{
-			return getBoolValue("bPerkPureMixture");
+			return _compiled.bPerkPureMixture;
 		}
 	#pragma endregion GMST_GETTERS
-	private:
-		[[nodiscard]] double calculate_base(const double base_val, const unsigned avAlchemy) const
-		{
-			const auto AVAlchemy{ static_cast<double>(avAlchemy) };
-			return	base_val
-				* fAlchemyIngredientInitMult()
-				* (1.0 + AVAlchemy / 200.0)
-				* (1.0 + (fAlchemySkillFactor() - 1.0))
-				* (AVAlchemy / 100.0)
-				* (1.0 + fAlchemyMod() / 100.0);
-		}
-		[[nodiscard]] double calculate_perks(double val, const Effect& effect, const unsigned avAlchemy) const
-		{
-			const auto AVAlchemy{ static_cast<double>(avAlchemy) };
-			const auto perk_mastery{ fPerkAlchemyMasteryRank() };
-			if (perk_mastery == 1u)
-				val *= 1.2;
-			else if (perk_mastery == 2u)
-				val *= 1.4;
-			if (bPerkAdvancedLab())
-				val *= 1.25;
-			if (bPerkBenefactor() && effect.hasKeyword(Keywords::KYWD_Beneficial))
-				val *= 1.25;
-			if (bPerkPoisoner() && effect.hasKeyword(Keywords::KYWD_Harmful) && !effect.hasKeyword(Keywords::KYWD_Beneficial))
-				val *= 1.0 + AVAlchemy * fPerkPoisonerFactor();
-			if (bPerkThatWhichDoesNotKillYou())
-				val *= 1.25;
-			return val;
-		}
 
-	public:
 		/**
 		 * @function apply_pure_mixture_perk(EffectList&, const bool)
 		 * @brief Applies the Pure Mixture perk to an effect list. (Removes negative effects from positive potions, or positive effects from negative potions.)
@@ -422,7 +515,7 @@ namespace caco_alch {
 		 */
 		[[nodiscard]] EffectList& apply_pure_mixture_perk(EffectList& effects, const bool rm_positive) const
 		{
-			if (bPerkPureMixture()) {
+			if (_compiled.bPerkPureMixture) {
 				EffectList keep{};
 				keep.reserve(effects.size());
 				for (auto& it : effects)
@@ -443,12 +536,12 @@ namespace caco_alch {
 		 */
 		[[nodiscard]] Effect calculate(const Effect& effect) const
 		{
-			const auto AlchemyAV{ fAlchemyAV() };
+			const auto mult{ _compiled.get_multiplier(effect) };
 			if (effect.hasKeyword(Keywords::KYWD_DurationBased)) {
-				double mag{ std::round(calculate_perks(calculate_base(effect._magnitude, AlchemyAV), effect, AlchemyAV)) };
+				double mag{ std::round(effect._magnitude * mult) };
 				return Effect{ effect._name, mag, effect._duration, effect._keywords };
 			}
-			unsigned dur{ static_cast<unsigned>(std::round(calculate_perks(calculate_base(effect._duration, AlchemyAV), effect, AlchemyAV))) };
+			unsigned dur{ static_cast<unsigned>(std::round(effect._duration * mult)) };
 			return Effect{ effect._name, effect._magnitude, dur, effect._keywords };
 		}
 
@@ -459,7 +552,7 @@ namespace caco_alch {
 		 */
 		[[nodiscard]] double get_power_factor() const
 		{
-			return fAlchemyIngredientInitMult() * (1.0 + (fAlchemySkillFactor() - 1.0) * fAlchemyAV() / 100.0);
+			return _compiled.fAlchemyIngredientInitMult * (1.0 + (_compiled.fAlchemySkillFactor - 1.0) * _compiled.fAlchemyAV / 100.0);
 		}
 
 		/**
@@ -1,4 +1,6 @@
 #pragma once
+#include <algorithm>
+#include <array>
 #include <utility>
 #include <var.hpp>
 
@@ -9,76 +11,41 @@
 namespace caco_alch {
 
 	/**
-	 * @function get_common_effects(const std::vector<Ingredient>&)
+	 * @function get_common_effects(const TIngrList&)
 	 * @brief Retrieve a list of common effects with the magnitude of the strongest effect of that type. (Base Magnitude)
-	 * @param ingr	- List of ingredients
+	 *		Occurrences are tracked in fixed-size storage, so only the common effects themselves are copied.
+	 * @tparam TIngrList	- Any range of Ingredients, such as IngrList or SortedIngrList.
+	 * @param ingr			- List of ingredients
 	 * @returns EffectList
 	 */
-	static EffectList get_common_effects(const IngrList& ingr)
+	template<typename TIngrList>
+	static EffectList get_common_effects(const TIngrList& ingr)
 	{
-		EffectList common, tmp;
-		constexpr auto is_duplicate{ [](EffectList& target, const Effect& fx) {
-			for ( auto it{ target.begin() }; it != target.end(); ++it )
-				if ( it->_name == fx._name ) // if effect names are the same, consider it a duplicate even though the magnitudes might be different
-					return it;
-			return target.end();
-		} };
+		constexpr size_t MAX_OCCURRENCES{ 4 * std::tuple_size_v<decltype(Ingredient::_effects)> };
+		// the first occurrence of each effect, and its position in the common list (or -1 if it only occurred once so far)
+		std::array<std::pair<const Effect*, int>, MAX_OCCURRENCES> seen{};
+		size_t seen_count{ 0 };
+		EffectList common;
 
 		for ( auto& i : ingr )
 			for ( auto& it : i._effects ) {
-				if ( auto dupl{ is_duplicate(tmp, it) }; dupl != tmp.end() ) { // if effect is a duplicate, push it to the common effects vector
-					if ( auto current{ is_duplicate(common, it) }; current == common.end() ) {
-						if ( it._magnitude < dupl->_magnitude )
-							common.push_back(*dupl); // if effect is not in the common list yet, add it
-						else
-							common.push_back(it);
-					}
-					else {
-						if ( it._magnitude > current->_magnitude)	// Set magnitude to largest (base_mag)
-							( *current )._magnitude = it._magnitude;
-						if ( it._duration > current->_duration )	// Set duration to largest (base_dur)
-							( *current )._duration = it._duration;
-					}
+				auto dupl{ std::find_if(seen.begin(), seen.begin() + seen_count, [&it](auto&& pr) { return pr.first->_name == it._name; }) };
+				if ( dupl == seen.begin() + seen_count ) {
+					if ( seen_count == seen.size() )
+						throw make_exception("Too many ingredients to find common effects! (Max ", MAX_OCCURRENCES, " effects)");
+					seen[seen_count++] = { &it, -1 };
 				}
-				else
-					tmp.emplace_back(it);
-			}
-		return common;
-	}
-	/**
-	 * @function get_common_effects(const std::vector<Ingredient>&)
-	 * @brief Retrieve a list of common effects with the magnitude of the strongest effect of that type. (Base Magnitude)
-	 * @param ingr	- List of ingredients
-	 * @returns EffectList
-	 */
-	static EffectList get_common_effects(const SortedIngrList& ingr)
-	{
-		EffectList common, tmp;
-		constexpr auto is_duplicate{ [](EffectList& target, const Effect& fx) {
-			for ( auto it{ target.begin() }; it != target.end(); ++it )
-				if ( it->_name == fx._name ) // if effect names are the same, consider it a duplicate even though the magnitudes might be different
-					return it;
-			return target.end();
-		} };
-
-		for ( auto& i : ingr )
-			for ( auto& it : i._effects ) {
-				if ( auto dupl{ is_duplicate(tmp, it) }; dupl != tmp.end() ) { // if effect is a duplicate, push it to the common effects vector
-					if ( auto current{ is_duplicate(common, it) }; current == common.end() ) {
-						if ( it._magnitude < dupl->_magnitude )
-							common.push_back(*dupl); // if effect is not in the common list yet, add it
-						else
-							common.push_back(it);
-					}
-					else {
-						if ( it._magnitude > current->_magnitude)	// Set magnitude to largest (base_mag)
-							( *current )._magnitude = it._magnitude;
-						if ( it._duration > current->_duration )	// Set duration to largest (base_dur)
-							( *current )._duration = it._duration;
-					}
+				else if ( dupl->second == -1 ) { // if effect is not in the common list yet, add the stronger occurrence
+					dupl->second = static_cast<int>(common.size());
+					common.push_back(it._magnitude < dupl->first->_magnitude ? *dupl->first : it);
+				}
+				else {
+					auto& current{ common[dupl->second] };
+					if ( it._magnitude > current._magnitude )	// Set magnitude to largest (base_mag)
+						current._magnitude = it._magnitude;
+					if ( it._duration > current._duration )	// Set duration to largest (base_dur)
+						current._duration = it._duration;
 				}
-				else
-					tmp.emplace_back(it);
 			}
 		return common;
 	}
@@ -123,10 +90,7 @@ namespace caco_alch {
 		}
 		explicit PotionBase(const SortedIngrList& ingredients)
 		{
-			IngrList ingr;
-			for (auto& it : ingredients)
-				ingr.push_back({ it });
-			const auto common{ get_common_effects(ingr) };
+			const auto common{ get_common_effects(ingredients) };
 			generate(common);
 			_base_fx = common;
 		}
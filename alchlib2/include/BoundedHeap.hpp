@@ -0,0 +1,69 @@
+#pragma once
+#include <sysarch.h>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace alchlib2 {
+	/**
+	 * @brief			Keeps the best items that were pushed into it, up to a fixed capacity, so memory stays bounded
+	 *					 no matter how many items are pushed.
+	 *					Items are kept in a heap with the worst item on top, so each push is O(log capacity).
+	 * @tparam T		The item type.
+	 * @tparam TBetter	A strict weak ordering that returns true when the first item is better than the second.
+	 */
+	template<typename T, typename TBetter = std::greater<T>>
+	class BoundedHeap {
+		size_t capacity;
+		TBetter better;
+		/// @brief	A heap with the worst item on top.
+		std::vector<T> items;
+
+	public:
+		BoundedHeap(const size_t capacity, TBetter better = {}) : capacity{ capacity }, better{ std::move(better) } {}
+
+		CONSTEXPR size_t size() const noexcept { return items.size(); }
+		CONSTEXPR bool empty() const noexcept { return items.empty(); }
+		CONSTEXPR size_t GetCapacity() const noexcept { return capacity; }
+		/// @brief	Checks if the heap is at capacity, so only items that are better than the worst one are kept.
+		CONSTEXPR bool IsFull() const noexcept { return items.size() >= capacity; }
+		/// @brief	Gets the worst item. The heap must not be empty.
+		CONSTEXPR const T& GetWorst() const noexcept { return items.front(); }
+
+		/**
+		 * @brief		Adds an item if there's room or if it's better than the worst item, which is then removed.
+		 * @param item	The item to add.
+		 * @returns		True when the item was kept.
+		 */
+		bool Push(T item)
+		{
+			if (IsFull()) {
+				if (capacity == 0 || !better(item, items.front()))
+					return false;
+				std::ranges::pop_heap(items, better);
+				items.pop_back();
+			}
+			items.emplace_back(std::move(item));
+			std::ranges::push_heap(items, better);
+			return true;
+		}
+
+		/// @brief	Pushes every item of another heap, such as the results of another thread.
+		void Merge(BoundedHeap&& other)
+		{
+			for (auto& item : other.items)
+				Push(std::move(item));
+			other.items.clear();
+		}
+
+		/// @brief	Removes every item & returns them ordered from best to worst.
+		std::vector<T> TakeSorted()
+		{
+			std::ranges::sort_heap(items, better);
+			auto sorted{ std::move(items) };
+			items.clear();
+			return sorted;
+		}
+	};
+}
@@ -0,0 +1,444 @@
+#pragma once
+#include "Inventory.hpp"
+#include "PotionValue.hpp"
+#include "RecipeEnumerator.hpp"
+
+#include <make_exception.hpp>
+
+#include <algorithm>
+
+namespace alchlib2 {
+	/// @brief	The value that BrewingPlanner maximizes.
+	enum class EPlanObjective : std::uint8_t {
+		/// @brief	The total gold value of every potion.
+		Value,
+		/// @brief	The number of potions that have the target effect.
+		EffectCount,
+	};
+
+	/// @brief	The objective & limits of a BrewingPlanner plan.
+	struct PlannerQuery {
+		EPlanObjective objective{ EPlanObjective::Value };
+		/// @brief	The effect that potions must have when the objective is EffectCount.
+		EffectID targetEffect{ NullEffectID };
+		/// @brief	The maximum number of ingredients per recipe.
+		size_t maxIngredients{ 3 };
+	};
+
+	/// @brief	A set of recipes to brew, & how many times to brew each one.
+	struct BrewingPlan {
+		struct Step {
+			PotionHandle potion;
+			unsigned count;
+			/// @brief	The score of a single potion.
+			float score;
+		};
+
+		/// @brief	Ordered by score, from best to worst.
+		std::vector<Step> steps;
+		/// @brief	The score of the whole plan.
+		float total{ 0.0f };
+		/// @brief	True when the plan is known to be the best possible plan.
+		bool optimal{ false };
+	};
+
+	/**
+	 * @brief		Plans a brewing session that gets the most out of an inventory, without using more of any ingredient than it has.
+	 *				Every useful recipe of the inventory's ingredients is evaluated once & given a score; plans are then built by
+	 *				 choosing how many times to brew each recipe, so changing a plan only updates the counts of the ingredients
+	 *				 of the recipes that were added or removed.
+	 *				The matrix, builder & calculator must outlive the planner.
+	 */
+	class BrewingPlanner {
+		const CompatibilityMatrix* matrix;
+		const PotionBuilder* builder;
+		const PotionCalculator* calculator;
+
+		struct Candidate {
+			Recipe recipe;
+			float score;
+			/// @brief	The score per ingredient used.
+			float density;
+		};
+
+		/// @brief	A plan that is being built, with the remaining number of each ingredient.
+		struct State {
+			std::vector<Candidate> const& candidates;
+			/// @brief	Indexed by IngredientID.
+			std::vector<unsigned> remaining;
+			/// @brief	The number of times each candidate is brewed, indexed by candidate.
+			std::vector<unsigned> uses;
+			/// @brief	The candidates that are brewed at least once & use each ingredient, indexed by IngredientID.
+			std::vector<std::vector<size_t>> users;
+			float total{ 0.0f };
+
+			State(std::vector<Candidate> const& candidates, Inventory const& inventory) :
+				candidates{ candidates },
+				remaining{ inventory.GetCounts().begin(), inventory.GetCounts().end() },
+				uses(candidates.size(), 0u),
+				users(remaining.size())
+			{}
+
+			/// @brief	Gets the number of times a candidate can be brewed with the remaining ingredients.
+			CONSTEXPR unsigned get_available(const size_t c) const noexcept
+			{
+				unsigned available{ std::numeric_limits<unsigned>::max() };
+				for (const auto& id : candidates[c].recipe.GetIngredients())
+					available = std::min(available, remaining[id]);
+				return available;
+			}
+			void add(const size_t c, const unsigned count)
+			{
+				if (count == 0)
+					return;
+				for (const auto& id : candidates[c].recipe.GetIngredients()) {
+					remaining[id] -= count;
+					if (uses[c] == 0)
+						users[id].emplace_back(c);
+				}
+				uses[c] += count;
+				total += candidates[c].score * $c(float, count);
+			}
+			void remove(const size_t c, const unsigned count)
+			{
+				if (count == 0)
+					return;
+				uses[c] -= count;
+				for (const auto& id : candidates[c].recipe.GetIngredients()) {
+					remaining[id] += count;
+					if (uses[c] == 0)
+						std::erase(users[id], c);
+				}
+				total -= candidates[c].score * $c(float, count);
+			}
+			/// @brief	Checks if the total is better than another total by more than rounding errors.
+			CONSTEXPR bool is_better_than(const float other) const noexcept
+			{
+				return total > other + 1e-4f * std::max(1.0f, std::abs(other));
+			}
+		};
+
+		/// @brief	Evaluates every useful recipe of the inventory's ingredients, & returns the ones with a score, sorted by density.
+		std::vector<Candidate> get_candidates(Inventory const& inventory, PlannerQuery const& query) const
+		{
+			const auto& index{ matrix->GetIndex() };
+			const auto& ingredients{ inventory.GetIngredients() };
+			const RecipeEnumerator enumerator{ *matrix, ingredients, 2, query.maxIngredients };
+
+			std::vector<Candidate> candidates;
+			std::vector<Recipe> recipes;
+			PotionBatch batch{ index };
+			const auto& flush{ [&]() {
+				builder->BuildMany(recipes, batch, *calculator);
+				for (size_t i{ 0 }; i < batch.size(); ++i) {
+					if (!batch.IsValid(i))
+						continue;
+					float score{ 0.0f };
+					if (query.objective == EPlanObjective::Value)
+						score = $c(float, get_potion_value(index.GetBaseCosts(), batch.GetEffectIDs(i), batch.GetMagnitudes(i), batch.GetDurations(i)));
+					else if (std::ranges::find(batch.GetEffectIDs(i), query.targetEffect) != batch.GetEffectIDs(i).end())
+						score = 1.0f;
+					if (score > 0.0f)
+						candidates.emplace_back(Candidate{ recipes[i], score, score / $c(float, recipes[i].count) });
+				}
+				recipes.clear();
+			} };
+			enumerator.ForEachRecipe([&](Recipe const& recipe) {
+				recipes.emplace_back(recipe);
+				if (recipes.size() == 4096)
+					flush();
+			});
+			flush();
+
+			std::ranges::stable_sort(candidates, [](auto&& l, auto&& r) { return l.density != r.density ? l.density > r.density : l.score > r.score; });
+			return candidates;
+		}
+
+		/// @brief	Brews every candidate as many times as possible, in order of density.
+		static void fill_greedy(State& state)
+		{
+			for (size_t c{ 0 }; c < state.candidates.size(); ++c)
+				if (const auto available{ state.get_available(c) }; available > 0)
+					state.add(c, available);
+		}
+
+		/// @brief	The candidates that use each ingredient, sorted by density, indexed by IngredientID.
+		using postings_t = std::vector<std::vector<size_t>>;
+
+		/**
+		 * @brief			Brews the densest candidates that use any of the given ingredients, until none of them can be brewed.
+		 *					The state couldn't brew any more candidates before the ingredients were freed, so only candidates
+		 *					 that use one of them need to be checked.
+		 * @param state		The current state.
+		 * @param postings	The candidates that use each ingredient.
+		 * @param freed		The ingredients that were freed.
+		 * @param added		Receives each candidate that was brewed.
+		 */
+		static void refill(State& state, postings_t const& postings, std::span<const IngredientID> freed, std::vector<size_t>& added)
+		{
+			for (bool found{ true }; found; ) {
+				found = false;
+				size_t best{ 0 };
+				for (const auto& id : freed) {
+					if (state.remaining[id] == 0)
+						continue;
+					for (const auto& other : postings[id]) {
+						if (found && state.candidates[other].density <= state.candidates[best].density)
+							break;
+						if (state.get_available(other) > 0) {
+							best = other;
+							found = true;
+							break;
+						}
+					}
+				}
+				if (found) {
+					state.add(best, 1);
+					added.emplace_back(best);
+				}
+			}
+		}
+
+		/**
+		 * @brief			Tries to replace one brew of a candidate with other brews that are worth more in total.
+		 * @param state		The current state.
+		 * @param postings	The candidates that use each ingredient.
+		 * @param c			The candidate to remove.
+		 * @returns			True when the replacement was kept.
+		 */
+		static bool try_replace(State& state, postings_t const& postings, const size_t c)
+		{
+			const auto before{ state.total };
+			state.remove(c, 1);
+
+			// the removed candidate is the densest one that fits, so it must not be brewed again right away
+			const auto ingredients{ state.candidates[c].recipe.GetIngredients() };
+			std::vector<size_t> added;
+			for (const auto& id : ingredients) {
+				if (state.remaining[id] == 0)
+					continue;
+				for (const auto& other : postings[id]) {
+					if (other != c && state.get_available(other) > 0) {
+						state.add(other, 1);
+						added.emplace_back(other);
+						refill(state, postings, ingredients, added);
+						break;
+					}
+				}
+				if (!added.empty())
+					break;
+			}
+
+			if (state.is_better_than(before))
+				return true;
+			for (const auto& other : added)
+				state.remove(other, 1);
+			state.add(c, 1);
+			return false;
+		}
+
+		/**
+		 * @brief			Tries to brew a candidate by removing one brew of the cheapest candidates that use its ingredients,
+		 *					 then refilling the ingredients that they freed. Only brews that are worth less than the candidate are removed.
+		 * @param state		The current state.
+		 * @param postings	The candidates that use each ingredient.
+		 * @param c			The candidate to add.
+		 * @returns			True when the change was kept.
+		 */
+		static bool try_insert(State& state, postings_t const& postings, const size_t c)
+		{
+			const auto before{ state.total };
+			std::vector<size_t> removed, added;
+			std::vector<IngredientID> freed;
+			for (const auto& id : state.candidates[c].recipe.GetIngredients()) {
+				if (state.remaining[id] != 0)
+					continue;
+				const auto& users{ state.users[id] };
+				const auto cheapest{ *std::ranges::min_element(users, [&state](auto&& l, auto&& r) { return state.candidates[l].score < state.candidates[r].score; }) };
+				// only brews that are worth less than the new one are evicted
+				if (state.candidates[cheapest].score >= state.candidates[c].score) {
+					for (const auto& other : removed)
+						state.add(other, 1);
+					return false;
+				}
+				state.remove(cheapest, 1);
+				removed.emplace_back(cheapest);
+				freed.insert(freed.end(), state.candidates[cheapest].recipe.GetIngredients().begin(), state.candidates[cheapest].recipe.GetIngredients().end());
+			}
+			state.add(c, 1);
+			added.emplace_back(c);
+			refill(state, postings, freed, added);
+
+			if (state.is_better_than(before))
+				return true;
+			for (const auto& other : added)
+				state.remove(other, 1);
+			for (const auto& other : removed)
+				state.add(other, 1);
+			return false;
+		}
+
+		/// @brief	Replaces & inserts single brews until neither improves the plan.
+		static void improve(State& state)
+		{
+			postings_t postings(state.remaining.size());
+			for (size_t c{ 0 }; c < state.candidates.size(); ++c)
+				for (const auto& id : state.candidates[c].recipe.GetIngredients())
+					postings[id].emplace_back(c);
+
+			for (bool improved{ true }; improved; ) {
+				improved = false;
+				for (size_t c{ 0 }; c < state.candidates.size(); ++c) {
+					while (state.uses[c] > 0 && try_replace(state, postings, c))
+						improved = true;
+					if (state.uses[c] == 0 && try_insert(state, postings, c))
+						improved = true;
+				}
+			}
+		}
+
+		/**
+		 * @brief			Searches every combination of brew counts, starting from the given candidate.
+		 *					The remaining ingredients can't be worth more than their number times the best remaining density,
+		 *					 which bounds each branch like the linear relaxation of the equivalent integer program.
+		 *					Branches are kept on an explicit stack, since a branch can be as deep as the number of candidates.
+		 * @param state		The current state.
+		 * @param first		The first candidate that can still be changed.
+		 * @param units		The total number of remaining ingredients.
+		 * @param best		The best state so far.
+		 * @param nodes		The number of remaining nodes that can be visited.
+		 */
+		static void search_exact(State& state, const size_t first, const unsigned units, State& best, size_t& nodes)
+		{
+			struct Branch {
+				/// @brief	The candidate whose brew count is being changed.
+				size_t candidate;
+				/// @brief	The total number of remaining ingredients before the candidate was brewed.
+				unsigned units;
+				/// @brief	The number of brews that are being tried, from the most available down to 0.
+				unsigned count;
+				/// @brief	True while count brews are added to the state.
+				bool applied;
+			};
+			std::vector<Branch> branches;
+
+			// records the state & adds a branch for the next candidate, unless it can't beat the best state
+			const auto& visit{ [&](size_t next, const unsigned remainingUnits) {
+				if (state.total > best.total) {
+					best.remaining = state.remaining;
+					best.uses = state.uses;
+					best.users = state.users;
+					best.total = state.total;
+				}
+				for (; next < state.candidates.size() && state.get_available(next) == 0; ++next) {}
+				if (next == state.candidates.size() || nodes == 0)
+					return;
+				if (state.total + state.candidates[next].density * $c(float, remainingUnits) <= best.total + 1e-4f * std::max(1.0f, best.total))
+					return;
+				branches.emplace_back(Branch{ next, remainingUnits, state.get_available(next), false });
+			} };
+
+			visit(first, units);
+			while (!branches.empty()) {
+				auto& branch{ branches.back() };
+				if (branch.applied) {
+					state.remove(branch.candidate, branch.count);
+					branch.applied = false;
+					if (branch.count == 0) {
+						branches.pop_back();
+						continue;
+					}
+					--branch.count;
+				}
+				if (nodes == 0) {
+					branches.pop_back();
+					continue;
+				}
+				--nodes;
+				state.add(branch.candidate, branch.count);
+				branch.applied = true;
+				// visit can reallocate branches, so the branch is copied out first
+				const auto next{ branch.candidate + 1 };
+				const auto remainingUnits{ branch.units - branch.count * $c(unsigned, state.candidates[branch.candidate].recipe.count) };
+				visit(next, remainingUnits);
+			}
+		}
+
+		/// @brief	Converts a state into a plan.
+		BrewingPlan make_plan(State const& state, const bool optimal) const
+		{
+			BrewingPlan plan;
+			for (size_t c{ 0 }; c < state.candidates.size(); ++c)
+				if (state.uses[c] > 0)
+					plan.steps.emplace_back(BrewingPlan::Step{ builder->Evaluate(matrix->GetIndex(), state.candidates[c].recipe, *calculator), state.uses[c], state.candidates[c].score });
+			std::ranges::stable_sort(plan.steps, [](auto&& l, auto&& r) { return l.score > r.score; });
+			plan.total = state.total;
+			plan.optimal = optimal;
+			return plan;
+		}
+
+		void validate(Inventory const& inventory, PlannerQuery const& query) const
+		{
+			if (inventory.size() != matrix->size())
+				throw make_exception("The inventory has ", inventory.size(), " ingredients, but the registry has ", matrix->size(), "!");
+			if (query.objective == EPlanObjective::EffectCount && query.targetEffect >= matrix->GetIndex().GetEffectCount())
+				throw make_exception("A target effect is required to count potions with an effect!");
+		}
+
+	public:
+		/**
+		 * @brief				Creates a planner for the registry that the given matrix was built from.
+		 * @param matrix		The compatibility matrix of the registry.
+		 * @param builder		The builder to evaluate recipes with.
+		 * @param calculator	The compiled game settings & perks to apply.
+		 */
+		BrewingPlanner(CompatibilityMatrix const& matrix, PotionBuilder const& builder, PotionCalculator const& calculator) :
+			matrix{ &matrix },
+			builder{ &builder },
+			calculator{ &calculator }
+		{}
+
+		/**
+		 * @brief			Plans a brewing session with a greedy search followed by local improvement.
+		 *					Recipes are brewed in order of their score per ingredient, then single brews are replaced with
+		 *					 better combinations of brews, & recipes that aren't brewed are forced in by removing the cheapest
+		 *					 brews in their way, until neither improves the plan anymore.
+		 * @param inventory	The ingredients that can be used.
+		 * @param query		The objective & limits of the plan.
+		 * @returns			A plan that is usually, but not always, the best one.
+		 */
+		BrewingPlan Plan(Inventory const& inventory, PlannerQuery const& query) const
+		{
+			validate(inventory, query);
+			const auto& candidates{ get_candidates(inventory, query) };
+			State state{ candidates, inventory };
+			fill_greedy(state);
+			improve(state);
+			return make_plan(state, false);
+		}
+
+		/**
+		 * @brief			Finds the best plan with an exact branch-and-bound search, starting from the plan that Plan() finds.
+		 *					The search is exponential in the number of recipes, so this is only practical for small inventories.
+		 * @param inventory	The ingredients that can be used.
+		 * @param query		The objective & limits of the plan.
+		 * @param nodeLimit	The maximum number of branches to visit. When it's reached, the best plan so far is returned.
+		 * @returns			The best plan, or the best plan found before the node limit was reached, which isn't marked as optimal.
+		 */
+		BrewingPlan PlanExact(Inventory const& inventory, PlannerQuery const& query, size_t nodeLimit = 10'000'000) const
+		{
+			validate(inventory, query);
+			const auto& candidates{ get_candidates(inventory, query) };
+			State best{ candidates, inventory };
+			fill_greedy(best);
+			improve(best);
+
+			State state{ candidates, inventory };
+			unsigned units{ 0 };
+			for (const auto& count : state.remaining)
+				units += count;
+			search_exact(state, 0, units, best, nodeLimit);
+			return make_plan(best, nodeLimit != 0);
+		}
+	};
+}
@@ -0,0 +1,143 @@
+#pragma once
+#include "RegistryIndex.hpp"
+
+#include <make_exception.hpp>
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace alchlib2 {
+	/// @brief	The maximum number of ingredients that can be combined into one potion.
+	inline constexpr const size_t MAX_POTION_INGREDIENTS{ 4 };
+	/// @brief	The maximum number of effects per ingredient that get_common_effects can handle.
+	inline constexpr const size_t MAX_INGREDIENT_EFFECTS{ 4 };
+	/// @brief	The maximum number of common effects a potion can have; each one requires at least 2 occurrences.
+	inline constexpr const size_t MAX_COMMON_EFFECTS{ MAX_POTION_INGREDIENTS * MAX_INGREDIENT_EFFECTS / 2 };
+
+	/// @brief	An effect shared by at least 2 ingredients, with the strongest magnitude & duration of any occurrence.
+	struct CommonEffect {
+		/// @brief	The position of the ingredient that the effect's name & keywords should be taken from.
+		std::uint8_t ingredient;
+		/// @brief	The position of the effect in that ingredient's effects.
+		std::uint8_t slot;
+		float magnitude;
+		unsigned duration;
+	};
+
+	/// @brief	A fixed-capacity list of common effects that never allocates.
+	class CommonEffectList {
+		std::array<CommonEffect, MAX_COMMON_EFFECTS> effects{};
+		std::uint8_t count{ 0 };
+
+	public:
+		CONSTEXPR size_t size() const noexcept { return count; }
+		CONSTEXPR bool empty() const noexcept { return count == 0; }
+		CONSTEXPR const CommonEffect* begin() const noexcept { return effects.data(); }
+		CONSTEXPR const CommonEffect* end() const noexcept { return effects.data() + count; }
+		CONSTEXPR CommonEffect* begin() noexcept { return effects.data(); }
+		CONSTEXPR CommonEffect* end() noexcept { return effects.data() + count; }
+		CONSTEXPR const CommonEffect& operator[](const size_t index) const noexcept { return effects[index]; }
+		CONSTEXPR CommonEffect& operator[](const size_t index) noexcept { return effects[index]; }
+
+		CONSTEXPR CommonEffect& push_back(CommonEffect const& effect)
+		{
+			if (count == effects.size())
+				throw make_exception("Potions can't have more than ", MAX_COMMON_EFFECTS, " common effects!");
+			return effects[count++] = effect;
+		}
+	};
+
+	/**
+	 * @brief		Finds the effects that are shared by at least 2 ingredients using fixed-size storage.
+	 *				This is the shared implementation of get_common_effects; TKey is whatever identifies
+	 *				 an effect, such as an EffectID or a name.
+	 */
+	template<typename TKey>
+	class CommonEffectAccumulator {
+		struct Occurrence {
+			TKey key;
+			CommonEffect effect;
+			/// @brief	The position of this effect in the common list, or -1 if it only occurred once so far.
+			std::int8_t common;
+		};
+
+		std::array<Occurrence, MAX_POTION_INGREDIENTS * MAX_INGREDIENT_EFFECTS> seen{};
+		std::uint8_t seenCount{ 0 };
+		CommonEffectList common;
+
+	public:
+		/**
+		 * @brief				Adds an occurrence of an effect.
+		 * @param key			The key that identifies the effect.
+		 * @param ingredient	The position of the ingredient that has the effect.
+		 * @param slot			The position of the effect in the ingredient's effects.
+		 * @param magnitude		The magnitude of this occurrence.
+		 * @param duration		The duration of this occurrence.
+		 */
+		CONSTEXPR void add(TKey const& key, const std::uint8_t ingredient, const std::uint8_t slot, const float magnitude, const unsigned duration)
+		{
+			const CommonEffect current{ ingredient, slot, magnitude, duration };
+			for (std::uint8_t i{ 0 }; i < seenCount; ++i) {
+				auto& first{ seen[i] };
+				if (!(first.key == key)) continue;
+
+				if (first.common == -1) { // second occurrence; take whichever is stronger
+					first.common = $c(std::int8_t, common.size());
+					common.push_back(magnitude < first.effect.magnitude ? first.effect : current);
+				}
+				else {
+					auto& effect{ common[first.common] };
+					if (magnitude > effect.magnitude)
+						effect.magnitude = magnitude;
+					if (duration > effect.duration)
+						effect.duration = duration;
+				}
+				return;
+			}
+			if (seenCount == seen.size())
+				throw make_exception("Potions can't have more than ", MAX_POTION_INGREDIENTS, " ingredients with ", MAX_INGREDIENT_EFFECTS, " effects each!");
+			seen[seenCount++] = Occurrence{ key, current, -1 };
+		}
+
+		/// @brief	Gets the common effects, in the order that their second occurrence was added.
+		CONSTEXPR const CommonEffectList& GetCommonEffects() const noexcept { return common; }
+	};
+
+	/**
+	 * @brief		Retrieve a list of common effects with the strongest available magnitude & duration from the given Ingredient list.
+	 *				Effects are considered to be the same when their names are equal.
+	 * @param ingr	List of ingredients
+	 * @returns		The common effects, referring to ingredients by their position in ingr.
+	 */
+	inline CONSTEXPR CommonEffectList get_common_effects(std::span<const Ingredient> ingr)
+	{
+		CommonEffectAccumulator<std::string_view> accumulator;
+		for (size_t i{ 0 }; i < ingr.size(); ++i)
+			for (size_t slot{ 0 }; slot < ingr[i].effects.size(); ++slot) {
+				const auto& effect{ ingr[i].effects[slot] };
+				accumulator.add(effect.name, $c(std::uint8_t, i), $c(std::uint8_t, slot), effect.magnitude, effect.duration);
+			}
+		return accumulator.GetCommonEffects();
+	}
+	/**
+	 * @brief				Retrieve a list of common effects with the strongest available magnitude & duration from the given ingredients.
+	 *						Effects are considered to be the same when they have the same (case-insensitive) EffectID.
+	 * @param index			The index of the registry that the ingredients belong to.
+	 * @param ingredients	The IDs of the ingredients.
+	 * @returns				The common effects, referring to ingredients by their position in ingredients.
+	 */
+	inline CONSTEXPR CommonEffectList get_common_effects(RegistryIndex const& index, std::span<const IngredientID> ingredients)
+	{
+		CommonEffectAccumulator<EffectID> accumulator;
+		for (size_t i{ 0 }; i < ingredients.size(); ++i) {
+			const auto& effectIDs{ index.GetEffectIDs(ingredients[i]) };
+			const auto& magnitudes{ index.GetMagnitudes(ingredients[i]) };
+			const auto& durations{ index.GetDurations(ingredients[i]) };
+			for (size_t slot{ 0 }; slot < effectIDs.size(); ++slot)
+				accumulator.add(effectIDs[slot], $c(std::uint8_t, i), $c(std::uint8_t, slot), magnitudes[slot], durations[slot]);
+		}
+		return accumulator.GetCommonEffects();
+	}
+}
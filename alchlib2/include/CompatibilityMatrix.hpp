@@ -0,0 +1,119 @@
+#pragma once
+#include "RegistryIndex.hpp"
+#include "CommonEffects.hpp"
+
+#include <make_exception.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <thread>
+
+namespace alchlib2 {
+	/**
+	 * @brief		A precomputed N×N matrix of the effects shared by each pair of ingredients in a registry.
+	 *				Each cell is one byte; the low nibble is a bitmask of the row ingredient's effect slots that
+	 *				 the column ingredient also has, and the high nibble is the column ingredient's matching slots.
+	 *				Ingredients are compatible when their cell is non-zero. Ingredients are never compatible with themselves.
+	 *				Each row is also available as a bitset of compatible ingredients.
+	 *				Like RegistryIndex, the matrix must be rebuilt whenever the registry is modified, and the index must outlive it.
+	 */
+	class CompatibilityMatrix {
+		const RegistryIndex* index;
+		size_t n;
+		std::vector<std::uint8_t> cells;
+		/// @brief	The number of 64-bit words in each row of bits.
+		size_t words;
+		/// @brief	The same matrix as one bit per cell, for combining rows with bitwise operations.
+		std::vector<std::uint64_t> bits;
+
+		/// @brief	Fills the rows in [first, last) using the effect postings of each row ingredient.
+		void build_rows(const IngredientID first, const IngredientID last) noexcept
+		{
+			for (IngredientID i{ first }; i < last; ++i) {
+				auto* row{ cells.data() + i * n };
+				auto* rowBits{ bits.data() + i * words };
+				const auto& effectIDs{ index->GetEffectIDs(i) };
+				for (std::uint8_t slot{ 0 }; slot < effectIDs.size(); ++slot) {
+					for (const auto& [other, otherSlot] : index->GetPostings(effectIDs[slot])) {
+						if (other == i) continue;
+						row[other] |= $c(std::uint8_t, (1u << slot) | (1u << (otherSlot + 4)));
+						rowBits[other / 64] |= std::uint64_t{ 1 } << (other % 64);
+					}
+				}
+			}
+		}
+
+	public:
+		/**
+		 * @brief				Builds the matrix for the registry that the given index was built from.
+		 * @param index			The index of the registry.
+		 * @param threadCount	The number of threads to build rows with. 0 uses one thread per hardware thread.
+		 */
+		CompatibilityMatrix(RegistryIndex const& index, unsigned threadCount = 0) : index{ &index }, n{ index.GetRegistry().size() }, cells(n * n, 0u), words{ (n + 63) / 64 }, bits(n * words, 0u)
+		{
+			for (IngredientID i{ 0 }; i < n; ++i)
+				if (index.GetEffectIDs(i).size() > MAX_INGREDIENT_EFFECTS)
+					throw make_exception("Ingredient '", index.GetIngredient(i).name, "' has more than ", MAX_INGREDIENT_EFFECTS, " effects, which isn't supported by the compatibility matrix!");
+
+			if (threadCount == 0)
+				threadCount = std::max(1u, std::thread::hardware_concurrency());
+			threadCount = std::min($c(unsigned, std::max(n, size_t{ 1 })), threadCount);
+
+			if (threadCount == 1) {
+				build_rows(0, $c(IngredientID, n));
+				return;
+			}
+
+			// each thread writes to its own contiguous block of rows
+			std::vector<std::thread> threads;
+			threads.reserve(threadCount);
+			const auto rowsPerThread{ (n + threadCount - 1) / threadCount };
+			for (size_t first{ 0 }; first < n; first += rowsPerThread)
+				threads.emplace_back(&CompatibilityMatrix::build_rows, this, $c(IngredientID, first), $c(IngredientID, std::min(n, first + rowsPerThread)));
+			for (auto& thread : threads)
+				thread.join();
+		}
+
+		/// @brief	Gets the index that the matrix was built from.
+		CONSTEXPR const RegistryIndex& GetIndex() const noexcept { return *index; }
+		/// @brief	Gets the number of ingredients in each row & column.
+		CONSTEXPR size_t size() const noexcept { return n; }
+
+		/// @brief	Gets the raw cell for the given pair of ingredients.
+		CONSTEXPR std::uint8_t Get(const IngredientID i, const IngredientID j) const noexcept { return cells[i * n + j]; }
+		/// @brief	Gets the row of the specified ingredient, indexed by the IngredientID of the other ingredient.
+		CONSTEXPR std::span<const std::uint8_t> GetRow(const IngredientID i) const noexcept { return{ cells.data() + i * n, n }; }
+
+		/// @brief	Gets the number of 64-bit words in each row returned by GetCompatibleBits.
+		CONSTEXPR size_t GetWordCount() const noexcept { return words; }
+		/**
+		 * @brief		Gets the row of the specified ingredient as a bitset, where bit j is set when ingredient j is compatible with it.
+		 *				Bit j is stored in word (j / 64) at position (j % 64); bits past the last ingredient are always 0.
+		 */
+		CONSTEXPR std::span<const std::uint64_t> GetCompatibleBits(const IngredientID i) const noexcept { return{ bits.data() + i * words, words }; }
+
+		/// @brief	Checks if the given ingredients share at least one effect.
+		CONSTEXPR bool IsCompatible(const IngredientID i, const IngredientID j) const noexcept { return Get(i, j) != 0; }
+		/// @brief	Gets a bitmask of the effect slots of ingredient i that ingredient j also has.
+		CONSTEXPR std::uint8_t GetSharedSlots(const IngredientID i, const IngredientID j) const noexcept { return Get(i, j) & 0xF; }
+		/// @brief	Gets the number of effects that the given ingredients share.
+		CONSTEXPR unsigned GetSharedEffectCount(const IngredientID i, const IngredientID j) const noexcept { return $c(unsigned, std::popcount(GetSharedSlots(i, j))); }
+
+		/**
+		 * @brief		Gets all ingredients that share at least one effect with the specified ingredient.
+		 * @param i		The ingredient to find partners for.
+		 * @returns		A ResultSet over the source registry.
+		 */
+		ResultSet GetCompatible(const IngredientID i) const
+		{
+			ResultSet results{ index->GetRegistry().Ingredients };
+			const auto& row{ GetRow(i) };
+			for (IngredientID j{ 0 }; j < row.size(); ++j)
+				if (row[j] != 0)
+					results.insert(j);
+			return results;
+		}
+	};
+}
@@ -6,13 +6,15 @@
 
 namespace alchlib2 {
 	struct Effect : INamedObject {
-		float magnitude;
-		unsigned duration;
+		float magnitude{ -0.0f };
+		unsigned duration{ 0u };
 		std::vector<Keyword> keywords;
+		/// @brief	The base cost of the magic effect, which determines how much it adds to the value of a potion. 0 when unknown.
+		float baseCost{ 0.0f };
 
 		/// @brief	Null effect constructor.
 		STRCONSTEXPR Effect() = default;
-		STRCONSTEXPR Effect(std::string const& name, const float magnitude, const unsigned duration, const std::vector<Keyword>& keywords = {}) : INamedObject(name), magnitude{ magnitude }, duration{ duration }, keywords{ keywords } {}
+		STRCONSTEXPR Effect(std::string const& name, const float magnitude, const unsigned duration, const std::vector<Keyword>& keywords = {}, const float baseCost = 0.0f) : INamedObject(name), magnitude{ magnitude }, duration{ duration }, keywords{ keywords }, baseCost{ baseCost } {}
 
 		[[nodiscard]] CONSTEXPR bool IsNullEffect() const { return magnitude == -0.0f && duration == 0u; }
 		[[nodiscard]] CONSTEXPR EKeywordDisposition GetDisposition() const
@@ -34,8 +36,7 @@ namespace alchlib2 {
 
 		[[nodiscard]] CONSTEXPR bool IsSimilarTo(const std::string& name, const bool requireExactMatch) const
 		{
-			const auto thisNameLower{ str::tolower(this->name) }, nameLower{ str::tolower(name) };
-			return requireExactMatch ? thisNameLower == nameLower : thisNameLower.find(nameLower) != std::string::npos;
+			return requireExactMatch ? text::equals(this->name, name) : text::contains(this->name, name);
 		}
 	};
 }
@@ -0,0 +1,46 @@
+#pragma once
+#include "Effect.hpp"
+#include "keywords/VanillaKeywords.h"
+
+#include <cstdint>
+
+namespace alchlib2 {
+	/// @brief	Classification flags for potions & effects.
+	enum class EPotionClass : std::uint8_t {
+		None = 0,
+		/// @brief	The strongest effect is harmful, so the potion is a poison.
+		Poison = 1,
+		/// @brief	At least one effect restores health, stamina or magicka.
+		Restore = 2,
+		/// @brief	At least one effect is beneficial.
+		Beneficial = 4,
+		/// @brief	At least one effect is harmful.
+		Harmful = 8,
+	};
+	$make_bitfield_operators(EPotionClass, std::uint8_t);
+
+	/// @brief	The keyword-derived properties of an effect, precomputed so that evaluating a potion doesn't need to compare keywords.
+	struct EffectTraits {
+		bool durationBased;
+		/// @brief	The Restore, Beneficial & Harmful flags of the effect.
+		EPotionClass classes;
+		EKeywordDisposition disposition;
+	};
+
+	/**
+	 * @brief			Gets the traits of an effect from its keywords.
+	 * @param effect	The effect to classify.
+	 * @returns			The EffectTraits of the effect.
+	 */
+	inline EffectTraits get_effect_traits(Effect const& effect)
+	{
+		EPotionClass classes{ EPotionClass::None };
+		if (effect.HasAnyKeyword(keywords::MagicAlchRestoreHealth, keywords::MagicAlchRestoreStamina, keywords::MagicAlchRestoreMagicka))
+			classes |= EPotionClass::Restore;
+		if (effect.HasAnyKeyword(keywords::MagicAlchBeneficial))
+			classes |= EPotionClass::Beneficial;
+		if (effect.HasAnyKeyword(keywords::MagicAlchHarmful))
+			classes |= EPotionClass::Harmful;
+		return{ effect.HasAnyKeyword(keywords::MagicAlchDurationBased), classes, effect.GetDisposition() };
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <sysarch.h>
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace alchlib2 {
+	/**
+	 * @brief		Builds a 64-bit FNV-1a hash of a sequence of values, for detecting when cached results are out of date.
+	 *				Values are hashed by their object representation, so the same values always produce the same fingerprint
+	 *				 on the same platform. It's not suitable for anything that needs to resist deliberate collisions.
+	 */
+	class Fingerprint {
+		std::uint64_t value{ 14695981039346656037ull };
+
+		CONSTEXPR void add_bytes(const unsigned char* bytes, const size_t size) noexcept
+		{
+			for (size_t i{ 0 }; i < size; ++i) {
+				value ^= bytes[i];
+				value *= 1099511628211ull;
+			}
+		}
+
+	public:
+		/// @brief	Adds a trivially copyable value to the fingerprint.
+		template<typename T> requires std::is_trivially_copyable_v<T>
+		Fingerprint& add(T const& v) noexcept
+		{
+			unsigned char bytes[sizeof(T)];
+			std::memcpy(bytes, &v, sizeof(T));
+			add_bytes(bytes, sizeof(T));
+			return *this;
+		}
+		/// @brief	Adds each value in a range to the fingerprint.
+		template<typename T> requires std::is_trivially_copyable_v<T>
+		Fingerprint& add(std::span<const T> values) noexcept
+		{
+			for (const auto& v : values)
+				add(v);
+			return *this;
+		}
+		/// @brief	Adds a string & its length to the fingerprint, so that consecutive strings can't run together.
+		Fingerprint& add(std::string_view const& s) noexcept
+		{
+			add(s.size());
+			add_bytes(reinterpret_cast<const unsigned char*>(s.data()), s.size());
+			return *this;
+		}
+
+		CONSTEXPR std::uint64_t get() const noexcept { return value; }
+		CONSTEXPR operator std::uint64_t() const noexcept { return value; }
+	};
+}
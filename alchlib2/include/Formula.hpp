@@ -17,16 +17,25 @@ namespace alchlib2 {
 
 		const AlchemyCoreGameSettings& coreGameSettings;
 
-		float GetResult(const float base_val) const override
+		/**
+		 * @brief		Gets the product of the game setting factors that every base value is multiplied by.
+		 *				This doesn't depend on the base value, so callers that evaluate many effects should get it once & reuse it.
+		 * @returns		The combined multiplier of the core alchemy formula.
+		 */
+		float GetMultiplier() const noexcept
 		{
-			return base_val
-				* coreGameSettings.fAlchemyIngredientInitMult
+			return coreGameSettings.fAlchemyIngredientInitMult
 				* (1.0f + coreGameSettings.fAlchemyAV / 200.0f)
 				* (1.0f + (coreGameSettings.fAlchemySkillFactor - 1.0f))
 				* (coreGameSettings.fAlchemyAV / 100.0f)
 				* (1.0f + coreGameSettings.fAlchemyMod / 100.0f);
 		}
 
+		float GetResult(const float base_val) const override
+		{
+			return base_val * GetMultiplier();
+		}
+
 		/**
 		 * @brief					Calculate the actual base value from the given starting base value.
 		 * @param base_val			Starting effect stat base value.
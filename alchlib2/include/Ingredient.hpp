@@ -7,32 +7,33 @@
 namespace alchlib2 {
 	struct Ingredient : INamedObject {
 		std::vector<Effect> effects;
+		/// @brief	The gold value of the ingredient. 0 when unknown.
+		unsigned value{ 0u };
+		/// @brief	The weight of the ingredient. 0 when unknown.
+		float weight{ 0.0f };
 
 		STRCONSTEXPR Ingredient() = default;
-		STRCONSTEXPR Ingredient(std::string const& name, const std::vector<Effect>& effects = {}) : INamedObject(name), effects{ effects } {}
+		STRCONSTEXPR Ingredient(std::string const& name, const std::vector<Effect>& effects = {}, const unsigned value = 0u, const float weight = 0.0f) : INamedObject(name), effects{ effects }, value{ value }, weight{ weight } {}
 
 	#pragma region IsSimilarTo
-		[[nodiscard]] CONSTEXPR bool IsSimilarTo(std::string name, const bool requireExactMatch) const
+		[[nodiscard]] CONSTEXPR bool IsSimilarTo(std::string const& name, const bool requireExactMatch) const
 		{
-			name = str::tolower(name);
-			const auto thisNameLower{ str::tolower(this->name) };
-			return requireExactMatch ? name == thisNameLower : thisNameLower.find(name) != std::string::npos;
+			return requireExactMatch ? text::equals(this->name, name) : text::contains(this->name, name);
 		}
 
-		[[nodiscard]] CONSTEXPR bool AnyEffectIsSimilarTo(std::string name, const bool requireExactMatch) const
+		[[nodiscard]] CONSTEXPR bool AnyEffectIsSimilarTo(std::string const& name, const bool requireExactMatch) const
 		{
-			name = str::tolower(name);
-			return std::any_of(effects.begin(), effects.end(), [&name, &requireExactMatch](auto&& effect) {
-				return requireExactMatch ? str::tolower(effect.name) == name : effect.IsSimilarTo(name, requireExactMatch);
+			const auto lc{ text::tolower(name) };
+			return std::any_of(effects.begin(), effects.end(), [&lc, &requireExactMatch](auto&& effect) {
+				return requireExactMatch ? text::equals(effect.name, lc) : text::find_first(effect.name, lc) != std::string_view::npos;
 			});
 		}
 
-		[[nodiscard]] CONSTEXPR bool AnyEffectKeywordIsSimilarTo(std::string name, const bool requireExactMatch) const
+		[[nodiscard]] CONSTEXPR bool AnyEffectKeywordIsSimilarTo(std::string const& name, const bool requireExactMatch) const
 		{
-			name = str::tolower(name);
 			return std::any_of(effects.begin(), effects.end(), [&name, &requireExactMatch](auto&& effect) -> bool {
 				return std::any_of(effect.keywords.begin(), effect.keywords.end(), [&name, &requireExactMatch](auto&& keyword) -> bool {
-					return requireExactMatch ? str::tolower(keyword.name) == name : keyword.IsSimilarTo(name, requireExactMatch);
+					return requireExactMatch ? text::equals(keyword.name, name) : keyword.IsSimilarTo(name, requireExactMatch);
 				});
 			});
 		}
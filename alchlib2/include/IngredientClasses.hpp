@@ -0,0 +1,184 @@
+#pragma once
+#include "Fingerprint.hpp"
+#include "PotionBatch.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+
+namespace alchlib2 {
+	/**
+	 * @brief		Groups the ingredients of a registry into classes of ingredients with the same effects, magnitudes & durations in
+	 *				 the same order, which always make the same potions as each other.
+	 *				 (Equivalent recipes can list the effects of a potion in a different order when their magnitudes are tied.)
+	 *				Merged registries often have many copies of the same ingredient, each of which multiplies the number of recipes
+	 *				 without making any new potions, so recipes only need to be searched over a few members of each class & can be
+	 *				 expanded back to every equivalent recipe when they're shown.
+	 *				Like CompatibilityMatrix, the classes must be rebuilt whenever the registry is modified.
+	 */
+	class IngredientClasses {
+		/// @brief	The class of each ingredient, indexed by IngredientID.
+		std::vector<std::uint32_t> classes;
+		/// @brief	The member of the same class before each ingredient, or NullIngredientID for the first member, indexed by IngredientID.
+		std::vector<IngredientID> previous;
+		/// @brief	The members of class c are in [offsets[c], offsets[c + 1]).
+		std::vector<std::uint32_t> offsets;
+		/// @brief	Grouped by class, in ascending order within each group.
+		std::vector<IngredientID> members;
+
+		/// @brief	Checks if two ingredients have the same effects, magnitudes & durations in the same order.
+		static bool is_equivalent(RegistryIndex const& index, const IngredientID l, const IngredientID r) noexcept
+		{
+			return std::ranges::equal(index.GetEffectIDs(l), index.GetEffectIDs(r))
+				&& std::ranges::equal(index.GetMagnitudes(l), index.GetMagnitudes(r))
+				&& std::ranges::equal(index.GetDurations(l), index.GetDurations(r));
+		}
+
+		/// @brief	The classes that a recipe uses, & how many members of each one.
+		struct Groups {
+			std::array<std::uint32_t, MAX_POTION_INGREDIENTS> classes;
+			std::array<std::uint8_t, MAX_POTION_INGREDIENTS> counts{};
+			size_t size{ 0 };
+		};
+		/// @brief	Groups the ingredients of a recipe by their class.
+		Groups get_groups(Recipe const& recipe) const noexcept
+		{
+			Groups groups;
+			for (const auto& id : recipe.GetIngredients()) {
+				const auto& it{ std::find(groups.classes.begin(), groups.classes.begin() + groups.size, classes[id]) };
+				if (it == groups.classes.begin() + groups.size)
+					groups.classes[groups.size++] = classes[id];
+				++groups.counts[it - groups.classes.begin()];
+			}
+			return groups;
+		}
+
+	public:
+		/**
+		 * @brief		Finds the classes of every ingredient by hashing their effects.
+		 * @param index	The index of the registry.
+		 */
+		IngredientClasses(RegistryIndex const& index) : classes(index.GetRegistry().size()), previous(index.GetRegistry().size(), NullIngredientID)
+		{
+			// each hash has a list of the first member of each class with that hash, in case of collisions
+			std::unordered_map<std::uint64_t, std::vector<IngredientID>> firstMembers;
+			std::vector<std::uint32_t> sizes;
+			for (IngredientID id{ 0 }; id < classes.size(); ++id) {
+				auto& candidates{ firstMembers[Fingerprint{}.add(index.GetEffectIDs(id)).add(index.GetMagnitudes(id)).add(index.GetDurations(id)).get()] };
+				const auto& it{ std::ranges::find_if(candidates, [&](auto&& first) { return is_equivalent(index, first, id); }) };
+				if (it != candidates.end())
+					classes[id] = classes[*it];
+				else {
+					candidates.emplace_back(id);
+					classes[id] = $c(std::uint32_t, sizes.size());
+					sizes.emplace_back(0u);
+				}
+				++sizes[classes[id]];
+			}
+
+			offsets.assign(sizes.size() + 1, 0u);
+			for (size_t c{ 0 }; c < sizes.size(); ++c)
+				offsets[c + 1] = offsets[c] + sizes[c];
+			members.resize(classes.size());
+			auto next{ offsets };
+			for (IngredientID id{ 0 }; id < classes.size(); ++id) {
+				if (next[classes[id]] != offsets[classes[id]])
+					previous[id] = members[next[classes[id]] - 1];
+				members[next[classes[id]]++] = id;
+			}
+		}
+
+		/// @brief	Gets the number of classes.
+		CONSTEXPR size_t size() const noexcept { return offsets.size() - 1; }
+		/// @brief	Checks if every ingredient is in a class of its own, so searching over classes wouldn't save anything.
+		CONSTEXPR bool IsTrivial() const noexcept { return size() == classes.size(); }
+		/// @brief	Gets the class of an ingredient.
+		CONSTEXPR std::uint32_t GetClass(const IngredientID id) const noexcept { return classes[id]; }
+		/// @brief	Gets the member of the same class before an ingredient, or NullIngredientID if it's the first member.
+		CONSTEXPR IngredientID GetPreviousMember(const IngredientID id) const noexcept { return previous[id]; }
+		/// @brief	Gets the members of a class, in ascending order.
+		CONSTEXPR std::span<const IngredientID> GetMembers(const std::uint32_t c) const noexcept { return{ members.data() + offsets[c], members.data() + offsets[c + 1] }; }
+
+		/**
+		 * @brief					Gets the ingredients that recipes need to be searched over to find every distinct potion.
+		 *							A recipe can use more than one member of a class, so up to maxIngredients members of each class are kept;
+		 *							 only the recipes that are IsCanonical() need to be evaluated.
+		 * @param maxIngredients	The maximum number of ingredients per recipe.
+		 * @returns					The lowest members of each class, in ascending order.
+		 */
+		std::vector<IngredientID> GetCandidates(const size_t maxIngredients) const
+		{
+			std::vector<IngredientID> candidates;
+			for (size_t c{ 0 }; c < size(); ++c) {
+				const auto& classMembers{ GetMembers($c(std::uint32_t, c)) };
+				candidates.insert(candidates.end(), classMembers.begin(), classMembers.begin() + std::min(maxIngredients, classMembers.size()));
+			}
+			std::ranges::sort(candidates);
+			return candidates;
+		}
+
+		/**
+		 * @brief			Checks if a recipe is the one that represents every recipe that's equivalent to it, which is the one that
+		 *					 uses the lowest members of each class. Searches over GetCandidates() find each potion once by skipping
+		 *					 every other recipe.
+		 * @param recipe	The recipe to check.
+		 * @returns			True when every ingredient is the first member of its class, or the member before it is also in the recipe.
+		 */
+		CONSTEXPR bool IsCanonical(Recipe const& recipe) const noexcept
+		{
+			const auto& ingredients{ recipe.GetIngredients() };
+			return std::ranges::all_of(ingredients, [&](auto&& id) {
+				return previous[id] == NullIngredientID || std::ranges::find(ingredients, previous[id]) != ingredients.end();
+			});
+		}
+
+		/**
+		 * @brief			Calls onRecipe with every recipe that makes the same potion as a recipe, including the recipe itself.
+		 *					When a recipe uses n members of a class, every combination of n members of that class is used in its place.
+		 * @param recipe	The recipe to expand.
+		 * @param onRecipe	A callable that accepts a Recipe. Each recipe has its ingredients in ascending order.
+		 */
+		template<typename TFunc>
+		void ForEachEquivalent(Recipe const& recipe, TFunc&& onRecipe) const
+		{
+			// pick each combination of members for each class in turn
+			const auto& groups{ get_groups(recipe) };
+			Recipe expanded;
+			expanded.count = recipe.count;
+			const auto& expand{ [&](auto&& self, const size_t group, const size_t pos, const size_t from, const size_t picked) -> void {
+				if (group == groups.size) {
+					auto sorted{ expanded };
+					std::sort(sorted.ingredients.begin(), sorted.ingredients.begin() + sorted.count);
+					onRecipe(std::as_const(sorted));
+					return;
+				}
+				const auto& classMembers{ GetMembers(groups.classes[group]) };
+				if (picked == groups.counts[group]) {
+					self(self, group + 1, pos, 0, 0);
+					return;
+				}
+				for (size_t m{ from }; m + (groups.counts[group] - picked) <= classMembers.size(); ++m) {
+					expanded.ingredients[pos] = classMembers[m];
+					self(self, group, pos + 1, m + 1, picked + 1);
+				}
+			} };
+			expand(expand, 0, 0, 0, 0);
+		}
+
+		/// @brief	Gets the number of recipes that ForEachEquivalent would call onRecipe with.
+		size_t GetEquivalentCount(Recipe const& recipe) const noexcept
+		{
+			const auto& groups{ get_groups(recipe) };
+			size_t total{ 1 };
+			for (size_t g{ 0 }; g < groups.size; ++g) {
+				// the number of combinations of counts[g] members, out of every member of the class
+				const auto n{ GetMembers(groups.classes[g]).size() };
+				size_t combinations{ 1 };
+				for (size_t k{ 1 }; k <= groups.counts[g]; ++k)
+					combinations = combinations * (n - groups.counts[g] + k) / k;
+				total *= combinations;
+			}
+			return total;
+		}
+	};
+}
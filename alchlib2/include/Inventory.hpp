@@ -0,0 +1,71 @@
+#pragma once
+#include "Registry.hpp"
+#include "ResultSet.hpp"
+
+#include <make_exception.hpp>
+#include <fileio.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <filesystem>
+
+namespace alchlib2 {
+	/**
+	 * @brief		The number of each ingredient in a registry that the player is holding.
+	 *				Inventory files are JSON objects that map ingredient names to counts, like { "Blue Mountain Flower": 5 }.
+	 */
+	class Inventory {
+		/// @brief	Indexed by IngredientID.
+		std::vector<unsigned> counts;
+
+	public:
+		/**
+		 * @brief					Creates an empty inventory.
+		 * @param ingredientCount	The number of ingredients in the registry.
+		 */
+		Inventory(const size_t ingredientCount) : counts(ingredientCount, 0u) {}
+
+		/**
+		 * @brief			Reads an inventory file.
+		 * @param path		The path of the file.
+		 * @param registry	The registry that the ingredient names refer to. Names are matched like build mode matches them.
+		 * @returns			The inventory. Counts of ingredients that are listed more than once are added together.
+		 */
+		[[nodiscard]] static Inventory ReadFrom(std::filesystem::path const& path, Registry const& registry)
+		{
+			nlohmann::json j;
+			file::read(path) >> j;
+			if (!j.is_object())
+				throw make_exception("Inventory file ", path, " must contain an object of ingredient names & counts!");
+
+			Inventory inventory{ registry.size() };
+			for (const auto& [name, count] : j.items()) {
+				if (!count.is_number_unsigned())
+					throw make_exception("Invalid count ", count.dump(), " for ingredient \"", name, "\" in inventory file ", path, "!");
+				const auto& it{ registry.find_best_fit(name, true, false) };
+				if (it == registry.end())
+					throw make_exception("Couldn't find an ingredient matching \"", name, "\" from inventory file ", path, "!");
+				inventory.counts[$c(size_t, std::distance(registry.begin(), it))] += count.get<unsigned>();
+			}
+			return inventory;
+		}
+
+		CONSTEXPR size_t size() const noexcept { return counts.size(); }
+		/// @brief	Gets the number of the specified ingredient.
+		CONSTEXPR unsigned Get(const IngredientID id) const { return counts[id]; }
+		/// @brief	Sets the number of the specified ingredient.
+		CONSTEXPR void Set(const IngredientID id, const unsigned count) { counts[id] = count; }
+		/// @brief	Gets the counts of all ingredients, indexed by IngredientID.
+		CONSTEXPR std::span<const unsigned> GetCounts() const noexcept { return counts; }
+
+		/// @brief	Gets the IDs of the ingredients that the inventory has at least one of, in ascending order.
+		std::vector<IngredientID> GetIngredients() const
+		{
+			std::vector<IngredientID> ids;
+			for (IngredientID id{ 0 }; id < counts.size(); ++id)
+				if (counts[id] != 0)
+					ids.emplace_back(id);
+			return ids;
+		}
+	};
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include "INamedObject.hpp"
 #include "EKeywordDisposition.h"
+#include "TextSearch.hpp"
 
 #include <strconv.hpp>
 
@@ -17,32 +18,31 @@ namespace alchlib2 {
 
 		friend STRCONSTEXPR bool operator==(Keyword const& l, Keyword const& r) noexcept
 		{
-			return str::tolower(l.name) == str::tolower(r.name) && str::tolower(l.formID) == str::tolower(r.formID);
+			return text::equals(l.name, r.name) && text::equals(l.formID, r.formID);
 		}
 		friend STRCONSTEXPR bool operator!=(Keyword const& l, Keyword const& r) noexcept
 		{
-			return str::tolower(l.name) != str::tolower(r.name) || str::tolower(l.formID) != str::tolower(r.formID);
+			return !operator==(l, r);
 		}
-		friend STRCONSTEXPR bool operator==(Keyword const& l, std::string s) noexcept
+		friend STRCONSTEXPR bool operator==(Keyword const& l, std::string const& s) noexcept
 		{
-			s = str::tolower(s);
-			return str::tolower(l.name) == s || str::tolower(l.formID) == s;
+			return text::equals(l.name, s) || text::equals(l.formID, s);
 		}
-		friend STRCONSTEXPR bool operator!=(Keyword const& l, std::string s) noexcept
+		friend STRCONSTEXPR bool operator!=(Keyword const& l, std::string const& s) noexcept
 		{
-			s = str::tolower(s);
-			return str::tolower(l.name) != s && str::tolower(l.formID) != s;
+			return !operator==(l, s);
 		}
 
 		STRCONSTEXPR bool IsSimilarTo(const Keyword& keyword) const
 		{
-			const auto lc_inname{ str::tolower(keyword.name) }, lc_infid{ str::tolower(keyword.formID) }, lc_name{ str::tolower(name) }, lc_fid{ str::tolower(formID) };
-			return operator==(*this, lc_inname) || operator==(*this, lc_infid) || lc_name.find(lc_inname) != std::string::npos || lc_fid.find(lc_infid) != std::string::npos;
+			return operator==(*this, keyword.name) || operator==(*this, keyword.formID) || text::contains(name, keyword.name) || text::contains(formID, keyword.formID);
 		}
-		STRCONSTEXPR bool IsSimilarTo(std::string name_or_id, const bool requireExactMatch) const
+		STRCONSTEXPR bool IsSimilarTo(std::string const& name_or_id, const bool requireExactMatch) const
 		{
-			name_or_id = str::tolower(name_or_id);
-			return operator==(*this, name_or_id) || (!requireExactMatch && (str::tolower(name).find(name_or_id) != std::string::npos || str::tolower(formID).find(name_or_id) != std::string::npos));
+			if (requireExactMatch)
+				return operator==(*this, name_or_id);
+			const auto lc{ text::tolower(name_or_id) };
+			return text::find_first(name, lc) != std::string_view::npos || text::find_first(formID, lc) != std::string_view::npos;
 		}
 	};
 }
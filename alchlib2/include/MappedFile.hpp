@@ -0,0 +1,49 @@
+#pragma once
+#include <sysarch.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace alchlib2 {
+	/**
+	 * @brief		A read-only memory mapping of a whole file, so that large files can be read in place without copying them.
+	 *				The mapping is released when the object is destroyed, which invalidates every pointer into it.
+	 */
+	class MappedFile {
+		const std::byte* data{ nullptr };
+		size_t size{ 0 };
+
+		void release() noexcept;
+
+	public:
+		/**
+		 * @brief		Maps a file into memory.
+		 * @param path	The path of the file, which must exist.
+		 */
+		MappedFile(std::filesystem::path const& path);
+		MappedFile(MappedFile const&) = delete;
+		MappedFile(MappedFile&& o) noexcept : data{ o.data }, size{ o.size }
+		{
+			o.data = nullptr;
+			o.size = 0;
+		}
+		~MappedFile() noexcept { release(); }
+
+		MappedFile& operator=(MappedFile const&) = delete;
+		MappedFile& operator=(MappedFile&& o) noexcept
+		{
+			if (this != &o) {
+				release();
+				data = o.data;
+				size = o.size;
+				o.data = nullptr;
+				o.size = 0;
+			}
+			return *this;
+		}
+
+		/// @brief	Gets the contents of the file. Empty files have no contents.
+		CONSTEXPR std::span<const std::byte> GetBytes() const noexcept { return{ data, size }; }
+	};
+}
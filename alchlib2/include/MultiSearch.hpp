@@ -0,0 +1,126 @@
+#pragma once
+#include "RegistryIndex.hpp"
+#include "TextSearch.hpp"
+
+#include <optional>
+
+namespace alchlib2 {
+	/// @brief	The section of a name that matched a search term.
+	struct Highlight {
+		std::uint32_t offset;
+		std::uint32_t length;
+	};
+	/// @brief	The sections of an ingredient's name & effect names that matched a search term.
+	struct IngredientHighlights {
+		std::optional<Highlight> name;
+		/// @brief	Parallel to Ingredient::effects.
+		std::vector<std::optional<Highlight>> effects;
+	};
+
+	/**
+	 * @brief		Searches ingredient & effect names for any number of search terms at once.
+	 *				Every ingredient name & every unique effect name is scanned exactly once, no matter how many
+	 *				 search terms there are. The results are grouped by search term, and the matched sections
+	 *				 of each name are kept so that they can be highlighted without searching again.
+	 *				The index must outlive the search.
+	 */
+	class MultiSearch {
+		using match_list = std::vector<std::pair<std::uint32_t, Highlight>>;
+
+		const RegistryIndex* index;
+		std::vector<std::string> terms;
+		/// @brief	The ingredients matched by each search term, indexed by term.
+		std::vector<ResultSet> groups;
+		/// @brief	The first match in each matching ingredient name, indexed by term. Sorted by IngredientID.
+		std::vector<match_list> ingredientMatches;
+		/// @brief	The first match in each matching effect name, indexed by term. Sorted by EffectID.
+		std::vector<match_list> effectMatches;
+
+		/// @brief	Groups the matches by term, keeping only the first match in each name. Exact matches must span the whole name.
+		static std::vector<match_list> collect(text::NameBlob const& names, text::MultiPattern const& patterns, const bool requireExactMatch)
+		{
+			std::vector<match_list> groups(patterns.size());
+			for (const auto& [term, index, offset] : names.find_all(patterns)) {
+				const auto length{ $c(std::uint32_t, patterns.term(term).size()) };
+				if (requireExactMatch && (offset != 0 || length != names[index].size()))
+					continue;
+				groups[term].emplace_back(index, Highlight{ offset, length });
+			}
+			for (auto& group : groups) {
+				std::stable_sort(group.begin(), group.end(), [](auto&& l, auto&& r) { return l.first < r.first; });
+				group.erase(std::unique(group.begin(), group.end(), [](auto&& l, auto&& r) { return l.first == r.first; }), group.end());
+			}
+			return groups;
+		}
+		static std::optional<Highlight> find_in(match_list const& matches, const std::uint32_t id)
+		{
+			const auto it{ std::lower_bound(matches.begin(), matches.end(), id, [](auto&& match, auto&& id) { return match.first < id; }) };
+			if (it == matches.end() || it->first != id)
+				return std::nullopt;
+			return it->second;
+		}
+
+	public:
+		/**
+		 * @brief					Searches the indexed registry for all of the given search terms.
+		 * @param index				The index of the registry to search.
+		 * @param terms				The search terms. These are not case-sensitive.
+		 * @param requireExactMatch	When true, names must be equal to a search term; otherwise names must contain a search term.
+		 * @param searchIngredients	When true, ingredient names are searched.
+		 * @param searchEffects		When true, effect names are searched.
+		 */
+		MultiSearch(const RegistryIndex& index, std::vector<std::string> const& terms, const bool requireExactMatch, const bool searchIngredients = true, const bool searchEffects = true) : index{ &index }, terms{ terms }
+		{
+			const text::MultiPattern patterns{ terms };
+
+			if (searchIngredients)
+				ingredientMatches = collect(index.GetIngredientNames(), patterns, requireExactMatch);
+			else ingredientMatches.resize(terms.size());
+			if (searchEffects)
+				effectMatches = collect(index.GetEffectNames(), patterns, requireExactMatch);
+			else effectMatches.resize(terms.size());
+
+			groups.reserve(terms.size());
+			for (size_t term{ 0 }; term < terms.size(); ++term) {
+				auto& results{ groups.emplace_back(index.GetRegistry().Ingredients) };
+				for (const auto& [ingredient, _] : ingredientMatches[term])
+					results.insert(ingredient);
+				for (const auto& [effect, _] : effectMatches[term])
+					for (const auto& posting : index.GetPostings(effect))
+						results.insert(posting.ingredient);
+			}
+		}
+
+		/// @brief	Gets the number of search terms.
+		CONSTEXPR size_t size() const noexcept { return terms.size(); }
+		/// @brief	Gets the search term at the specified position, as it was given to the constructor.
+		CONSTEXPR const std::string& GetTerm(const size_t term) const { return terms[term]; }
+		/// @brief	Gets the ingredients that matched the specified search term.
+		CONSTEXPR const ResultSet& GetResults(const size_t term) const { return groups[term]; }
+
+		/// @brief	Gets the IDs of the effects whose names matched the specified search term, in ascending order.
+		std::vector<EffectID> GetMatchedEffects(const size_t term) const
+		{
+			std::vector<EffectID> ids;
+			ids.reserve(effectMatches[term].size());
+			for (const auto& [effect, _] : effectMatches[term])
+				ids.emplace_back(effect);
+			return ids;
+		}
+
+		/// @brief	Gets the section of the specified ingredient's name that matched the specified search term, if any.
+		std::optional<Highlight> GetIngredientHighlight(const size_t term, const IngredientID id) const { return find_in(ingredientMatches[term], id); }
+		/// @brief	Gets the section of the specified effect's name that matched the specified search term, if any.
+		std::optional<Highlight> GetEffectHighlight(const size_t term, const EffectID id) const { return find_in(effectMatches[term], id); }
+		/// @brief	Gets the sections of the specified ingredient's name & effect names that matched the specified search term.
+		IngredientHighlights GetHighlights(const size_t term, const IngredientID id) const
+		{
+			IngredientHighlights highlights{ GetIngredientHighlight(term, id), {} };
+			const auto& effectIDs{ index->GetEffectIDs(id) };
+			highlights.effects.reserve(effectIDs.size());
+			for (const auto& effectID : effectIDs)
+				highlights.effects.emplace_back(GetEffectHighlight(term, effectID));
+			return highlights;
+		}
+	};
+}
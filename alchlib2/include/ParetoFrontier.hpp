@@ -0,0 +1,109 @@
+#pragma once
+#include "PotionHandle.hpp"
+
+#include <make_exception.hpp>
+
+#include <algorithm>
+#include <array>
+
+namespace alchlib2 {
+	/// @brief	The maximum number of objectives that a ParetoFrontier can compare.
+	inline constexpr size_t MAX_PARETO_OBJECTIVES{ 4 };
+
+	/// @brief	A recipe on a ParetoFrontier, with its score for each objective.
+	struct ParetoPoint {
+		PotionHandle potion;
+		/// @brief	Only the first ParetoFrontier::GetDimensions() scores are used.
+		std::array<float, MAX_PARETO_OBJECTIVES> scores{};
+	};
+
+	/**
+	 * @brief		The set of recipes that aren't dominated by any other recipe that was inserted, where every objective is maximized.
+	 *				A recipe dominates another when it scores at least as well for every objective & better for at least one.
+	 *				Recipes with identical scores don't dominate each other, so they're all kept.
+	 *				The frontier is kept sorted by the first objective, so each insertion only compares the new recipe against
+	 *				 the recipes that could dominate it, or that it could dominate, instead of filtering every recipe at the end.
+	 */
+	class ParetoFrontier {
+		size_t dimensions;
+		/// @brief	Sorted by the first score, in descending order.
+		std::vector<ParetoPoint> points;
+
+		/// @brief	Checks if scores l dominate scores r.
+		CONSTEXPR bool dominates(std::array<float, MAX_PARETO_OBJECTIVES> const& l, std::array<float, MAX_PARETO_OBJECTIVES> const& r) const noexcept
+		{
+			bool better{ false };
+			for (size_t d{ 0 }; d < dimensions; ++d) {
+				if (l[d] < r[d])
+					return false;
+				if (l[d] > r[d])
+					better = true;
+			}
+			return better;
+		}
+
+	public:
+		/**
+		 * @brief				Creates an empty frontier.
+		 * @param dimensions	The number of objectives to compare, from 1 to MAX_PARETO_OBJECTIVES.
+		 */
+		ParetoFrontier(const size_t dimensions) : dimensions{ dimensions }
+		{
+			if (dimensions == 0 || dimensions > MAX_PARETO_OBJECTIVES)
+				throw make_exception("Invalid number of objectives: ", dimensions, "! (Must be within 1 to ", MAX_PARETO_OBJECTIVES, ")");
+		}
+
+		CONSTEXPR size_t GetDimensions() const noexcept { return dimensions; }
+		CONSTEXPR size_t size() const noexcept { return points.size(); }
+		CONSTEXPR bool empty() const noexcept { return points.empty(); }
+		/// @brief	Gets the recipes on the frontier, in descending order of their first score.
+		CONSTEXPR std::span<const ParetoPoint> GetPoints() const noexcept { return points; }
+
+		/**
+		 * @brief			Checks if a recipe with the given scores wouldn't be added to the frontier.
+		 * @param scores	The scores of the recipe.
+		 * @returns			True when a recipe on the frontier dominates the scores.
+		 */
+		bool IsDominated(std::array<float, MAX_PARETO_OBJECTIVES> const& scores) const noexcept
+		{
+			// only recipes with a first score that is at least as good can dominate it
+			for (const auto& point : points) {
+				if (point.scores[0] < scores[0])
+					break;
+				if (dominates(point.scores, scores))
+					return true;
+			}
+			return false;
+		}
+
+		/**
+		 * @brief			Inserts a recipe, removing every recipe that it dominates.
+		 * @param point		The recipe & its scores.
+		 * @returns			True when the recipe was added, or false when another recipe dominates it.
+		 */
+		bool Insert(ParetoPoint const& point)
+		{
+			if (IsDominated(point.scores))
+				return false;
+
+			// only recipes with a first score that is at most as good can be dominated by it
+			const auto& first{ std::ranges::lower_bound(points, point.scores[0], std::greater<>{}, [](auto&& p) { return p.scores[0]; }) };
+			const auto& removed{ std::remove_if(first, points.end(), [this, &point](auto&& p) { return dominates(point.scores, p.scores); }) };
+			points.erase(removed, points.end());
+
+			// insert after recipes with an equal first score, so ties stay in insertion order
+			const auto& pos{ std::ranges::upper_bound(points, point.scores[0], std::greater<>{}, [](auto&& p) { return p.scores[0]; }) };
+			points.insert(pos, point);
+			return true;
+		}
+
+		/// @brief	Inserts every recipe on another frontier that has the same number of objectives.
+		void Merge(ParetoFrontier const& other)
+		{
+			if (other.dimensions != dimensions)
+				throw make_exception("Can't merge a frontier with ", other.dimensions, " objectives into a frontier with ", dimensions, " objectives!");
+			for (const auto& point : other.points)
+				Insert(point);
+		}
+	};
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "PerkBase.hpp"
+
+#include <concepts>
+#include <tuple>
+
+namespace alchlib2 {
+	/**
+	 * @brief			A fixed sequence of concrete perk types that are applied without virtual calls or allocations.
+	 *					The pipeline refers to the perks rather than copying them, so enabling or disabling a perk
+	 *					 takes effect immediately, and the perks must outlive the pipeline.
+	 *					Use Perk & std::vector<Perk> for perks that aren't known at compile time.
+	 * @tparam TPerks	The concrete perk types, in the order that they should be applied.
+	 */
+	template<std::derived_from<PerkBase>... TPerks>
+	class PerkPipeline {
+		std::tuple<const TPerks*...> perks;
+
+		template<typename TPerk>
+		static CONSTEXPR void apply_to_effect(TPerk const& perk, Effect& effect) noexcept
+		{
+			if (perk.enable) perk.TPerk::ApplyToEffect(effect);
+		}
+		template<typename TPerk>
+		static CONSTEXPR void apply_to_potion(TPerk const& perk, Potion& potion) noexcept
+		{
+			if (perk.enable) perk.TPerk::ApplyToPotion(potion);
+		}
+
+	public:
+		CONSTEXPR PerkPipeline(TPerks const&... perks) : perks{ &perks... } {}
+
+		/**
+		 * @brief			Applies the transformations of each enabled perk (if any) to the given Effect.
+		 * @param effect	An Effect reference to modify.
+		 */
+		CONSTEXPR void ApplyToEffect(Effect& effect) const noexcept
+		{
+			std::apply([&effect](auto const*... perk) { (apply_to_effect(*perk, effect), ...); }, perks);
+		}
+		/**
+		 * @brief			Applies the transformations of each enabled perk (if any) to the given Potion.
+		 * @param potion	A Potion reference to modify.
+		 */
+		CONSTEXPR void ApplyToPotion(Potion& potion) const noexcept
+		{
+			std::apply([&potion](auto const*... perk) { (apply_to_potion(*perk, potion), ...); }, perks);
+		}
+	};
+
+	/// @brief	Applies a list of dynamic perks to the given Effect.
+	inline void ApplyPerksToEffect(std::vector<Perk> const& perks, Effect& effect)
+	{
+		for (const auto& perk : perks)
+			perk.ApplyToEffect(effect);
+	}
+	/// @brief	Applies a list of dynamic perks to the given Potion.
+	inline void ApplyPerksToPotion(std::vector<Perk> const& perks, Potion& potion)
+	{
+		for (const auto& perk : perks)
+			perk.ApplyToPotion(potion);
+	}
+	/// @brief	Applies a static perk pipeline to the given Effect.
+	template<typename... TPerks>
+	CONSTEXPR void ApplyPerksToEffect(PerkPipeline<TPerks...> const& perks, Effect& effect) noexcept
+	{
+		perks.ApplyToEffect(effect);
+	}
+	/// @brief	Applies a static perk pipeline to the given Potion.
+	template<typename... TPerks>
+	CONSTEXPR void ApplyPerksToPotion(PerkPipeline<TPerks...> const& perks, Potion& potion) noexcept
+	{
+		perks.ApplyToPotion(potion);
+	}
+}
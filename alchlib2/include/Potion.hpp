@@ -9,14 +9,18 @@ namespace alchlib2 {
 		STRCONSTEXPR Potion() {}
 		STRCONSTEXPR Potion(std::string const& name, std::vector<Effect> const& effects) : INamedObject(name), effects{ effects } {}
 
-		[[nodiscard]] Effect GetStrongestEffect() const noexcept
+		/// @brief	Gets the effect with the highest magnitude, or a null effect if the potion doesn't have any effects.
+		[[nodiscard]] const Effect& GetStrongestEffect() const noexcept
 		{
-			std::vector<Effect>::const_iterator strongest;
+			static const Effect nullEffect{};
+			auto strongest{ effects.end() };
 			for (auto it{ effects.begin() }; it != effects.end(); ++it) {
 				if (strongest == effects.end() || it->magnitude > strongest->magnitude) {
 					strongest = it;
 				}
 			}
+			if (strongest == effects.end())
+				return nullEffect;
 			return *strongest;
 		}
 
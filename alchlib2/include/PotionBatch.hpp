@@ -0,0 +1,135 @@
+#pragma once
+#include "CommonEffects.hpp"
+
+#include <make_exception.hpp>
+
+#include <initializer_list>
+
+namespace alchlib2 {
+	/// @brief	Placeholder for unused ingredient slots.
+	inline constexpr const IngredientID NullIngredientID{ std::numeric_limits<IngredientID>::max() };
+
+	/// @brief	A combination of up to MAX_POTION_INGREDIENTS ingredients, referred to by their position in the registry.
+	struct Recipe {
+		std::array<IngredientID, MAX_POTION_INGREDIENTS> ingredients;
+		std::uint8_t count;
+
+		CONSTEXPR Recipe() : ingredients{}, count{ 0 } { ingredients.fill(NullIngredientID); }
+		CONSTEXPR Recipe(std::initializer_list<IngredientID> ids) : Recipe()
+		{
+			if (ids.size() > MAX_POTION_INGREDIENTS)
+				throw make_exception("Recipes can't have more than ", MAX_POTION_INGREDIENTS, " ingredients!");
+			for (const auto& id : ids)
+				ingredients[count++] = id;
+		}
+
+		CONSTEXPR std::span<const IngredientID> GetIngredients() const noexcept { return{ ingredients.data(), count }; }
+	};
+
+	/**
+	 * @brief				Generates the name of a potion from its effects. This is equivalent to PotionBuilder::GetNameFromEffects.
+	 *						Potions are named after perks were applied, so effects that Purity removed don't count towards the prefix.
+	 *						Effect names are taken from the first occurrence of each effect in the registry.
+	 * @param index			The index of the registry that the effects belong to.
+	 * @param effectIDs		The EffectIDs of the potion's effects.
+	 * @param magnitudes	The magnitudes of the potion's effects, in the same order as effectIDs.
+	 * @returns				The name of the potion.
+	 */
+	inline std::string get_potion_name(RegistryIndex const& index, std::span<const EffectID> effectIDs, std::span<const float> magnitudes)
+	{
+		size_t strongest{ effectIDs.size() };
+		for (size_t e{ 0 }; e < magnitudes.size(); ++e)
+			if (strongest == effectIDs.size() || magnitudes[e] > magnitudes[strongest])
+				strongest = e;
+		if (strongest == effectIDs.size())
+			return "Potion";
+		const auto& effectID{ effectIDs[strongest] };
+		const std::string suffix{ " of " + index.GetEffect(effectID).name };
+		if (index.GetTraits(effectID).disposition >= EKeywordDisposition::Negative)
+			return "Poison" + suffix;
+		else if (effectIDs.size() > 2)
+			return "Elixir" + suffix;
+		else if (effectIDs.size() == 2)
+			return "Draught" + suffix;
+		return "Potion" + suffix;
+	}
+
+	/**
+	 * @brief		The results of evaluating many recipes at once, stored in columns rather than as Potion objects.
+	 *				Each recipe has up to MAX_COMMON_EFFECTS effects, stored at (position * MAX_COMMON_EFFECTS) in the effect columns.
+	 *				Names aren't generated until GetName() is called.
+	 *				A batch can be filled repeatedly by PotionBuilder::BuildMany without reallocating.
+	 *				The index must outlive the batch.
+	 */
+	class PotionBatch {
+		friend struct PotionBuilder;
+		friend class PotionCalculator;
+
+		const RegistryIndex* index;
+
+		std::vector<Recipe> recipes;
+		std::vector<std::uint8_t> valid;
+		std::vector<EPotionClass> classes;
+		std::vector<std::uint8_t> effectCounts;
+		std::vector<EffectID> effectIDs;
+		std::vector<float> magnitudes;
+		std::vector<unsigned> durations;
+
+		void resize(const size_t count)
+		{
+			recipes.resize(count);
+			valid.resize(count);
+			classes.resize(count);
+			effectCounts.resize(count);
+			effectIDs.resize(count * MAX_COMMON_EFFECTS);
+			magnitudes.resize(count * MAX_COMMON_EFFECTS);
+			durations.resize(count * MAX_COMMON_EFFECTS);
+		}
+
+	public:
+		/**
+		 * @brief		Creates an empty batch for recipes from the specified index.
+		 * @param index	The index of the registry that recipes refer to.
+		 */
+		PotionBatch(RegistryIndex const& index) : index{ &index } {}
+
+		/// @brief	Gets the index that recipes in this batch refer to.
+		CONSTEXPR const RegistryIndex& GetIndex() const noexcept { return *index; }
+		/// @brief	Gets the precomputed traits of the specified effect.
+		CONSTEXPR const EffectTraits& GetTraits(const EffectID id) const { return index->GetTraits(id); }
+
+		CONSTEXPR size_t size() const noexcept { return recipes.size(); }
+		CONSTEXPR bool empty() const noexcept { return recipes.empty(); }
+
+		CONSTEXPR const Recipe& GetRecipe(const size_t i) const { return recipes[i]; }
+		/// @brief	Checks if the recipe has at least 2 unique ingredients that exist in the registry, and makes a potion with at least one effect.
+		CONSTEXPR bool IsValid(const size_t i) const { return valid[i] != 0; }
+		CONSTEXPR EPotionClass GetClass(const size_t i) const { return classes[i]; }
+		CONSTEXPR bool IsPoison(const size_t i) const { return (classes[i] & EPotionClass::Poison) != EPotionClass::None; }
+
+		CONSTEXPR size_t GetEffectCount(const size_t i) const { return effectCounts[i]; }
+		/// @brief	Gets the EffectIDs of the potion's effects, in the same order as Potion::effects.
+		CONSTEXPR std::span<const EffectID> GetEffectIDs(const size_t i) const { return{ effectIDs.data() + i * MAX_COMMON_EFFECTS, effectCounts[i] }; }
+		/// @brief	Gets the magnitudes of the potion's effects, after applying the core alchemy formula & any perks from a PotionCalculator.
+		CONSTEXPR std::span<const float> GetMagnitudes(const size_t i) const { return{ magnitudes.data() + i * MAX_COMMON_EFFECTS, effectCounts[i] }; }
+		/// @brief	Gets the durations of the potion's effects, after applying the core alchemy formula.
+		CONSTEXPR std::span<const unsigned> GetDurations(const size_t i) const { return{ durations.data() + i * MAX_COMMON_EFFECTS, effectCounts[i] }; }
+
+		/// @brief	Gets the position of the strongest effect in the potion, or MAX_COMMON_EFFECTS if it doesn't have any effects.
+		CONSTEXPR size_t GetStrongestEffect(const size_t i) const
+		{
+			size_t strongest{ MAX_COMMON_EFFECTS };
+			const auto& magnitudes{ GetMagnitudes(i) };
+			for (size_t e{ 0 }; e < magnitudes.size(); ++e)
+				if (strongest == MAX_COMMON_EFFECTS || magnitudes[e] > magnitudes[strongest])
+					strongest = e;
+			return strongest;
+		}
+
+		/// @brief	Generates the name of the potion from its effects after perks were applied, which is the same name that PotionBuilder::Build gives it.
+		std::string GetName(const size_t i) const
+		{
+			return get_potion_name(*index, GetEffectIDs(i), GetMagnitudes(i));
+		}
+	};
+}
@@ -2,51 +2,125 @@
 #include "Potion.hpp"
 #include "Formula.hpp"
 #include "PerkBase.hpp"
+#include "PerkPipeline.hpp"
+#include "CommonEffects.hpp"
+#include "PotionBatch.hpp"
+#include "PotionHandle.hpp"
+#include "PotionCalculator.hpp"
 
 #include "perks/VanillaPerks.h"
 
 namespace alchlib2 {
-	/**
-	 * @brief		Retrieve a list of common effects with the strongest available magnitude & duration from the given Ingredient list.
-	 * @param ingr	List of ingredients
-	 * @returns		std::vector<Effect>
-	 */
-	static CONSTEXPR std::vector<Effect> get_common_effects(const std::vector<Ingredient>& ingr)
-	{
-		std::vector<Effect> common, tmp;
-		constexpr auto is_duplicate{ [](std::vector<Effect>& target, const Effect& fx) {
-			for (auto it{ target.begin() }; it != target.end(); ++it)
-				if (it->name == fx.name) // if effect names are the same, consider it a duplicate even though the magnitudes might be different
-					return it;
-			return target.end();
-		} };
+	struct PotionBuilder {
+		AlchemyCoreFormula coreFormula;
+
+	private:
+		/**
+		 * @brief			Creates a potion from a list of common effects. This is the only step of building a potion that allocates.
+		 * @param common	The common effects of the potion.
+		 * @param getEffect	A callable that returns the source Effect for a CommonEffect, to copy the name & keywords from.
+		 * @param perks		The perks to apply to the potion; either a std::vector<Perk> or a PerkPipeline.
+		 */
+		template<typename TGetEffect, typename TPerks>
+		[[nodiscard]] Potion materialize(CommonEffectList const& common, TGetEffect const& getEffect, TPerks const& perks) const
+		{
+			Potion p;
+			p.effects.reserve(common.size());
+			for (const auto& it : common) {
+				auto& effect{ p.effects.emplace_back(getEffect(it)) };
+				effect.magnitude = it.magnitude;
+				effect.duration = it.duration;
 
-		for (auto& i : ingr) {
-			for (auto& it : i.effects) {
-				if (auto dupl{ is_duplicate(tmp, it) }; dupl != tmp.end()) { // if effect is a duplicate, push it to the common effects vector
-					if (auto current{ is_duplicate(common, it) }; current == common.end()) {
-						if (it.magnitude < dupl->magnitude)
-							common.push_back(*dupl); // if effect is not in the common list yet, add it
-						else
-							common.push_back(it);
-					}
-					else {
-						if (it.magnitude > current->magnitude)	// Set magnitude to largest (base_mag)
-							(*current).magnitude = it.magnitude;
-						if (it.duration > current->duration)	// Set duration to largest (base_dur)
-							(*current).duration = it.duration;
-					}
-				}
+				if (effect.HasAnyKeyword(keywords::MagicAlchDurationBased))
+					effect.duration = std::round(coreFormula.GetResult(effect.magnitude));
 				else
-					tmp.emplace_back(it);
+					effect.magnitude = std::round(coreFormula.GetResult(effect.magnitude));
+
+				ApplyPerksToEffect(perks, effect);
 			}
+			// the potion is named after perks like Purity have removed effects, so a purified elixir with one effect left is a "Potion"
+			ApplyPerksToPotion(perks, p);
+
+			p.name = GetNameFromEffects(p.effects);
+			return p;
 		}
-		return common;
-	}
 
-	struct PotionBuilder {
-		AlchemyCoreFormula coreFormula;
+		/**
+		 * @brief					Applies the core alchemy formula to the common effects of a recipe, without any perks.
+		 * @param index				The index of the registry that the ingredients belong to.
+		 * @param ingredients		The IDs of the ingredients.
+		 * @param coreMultiplier	The multiplier of the core alchemy formula, from AlchemyCoreFormula::GetMultiplier.
+		 * @param effectIDs			Receives the EffectID of each common effect. Must have room for MAX_COMMON_EFFECTS.
+		 * @param magnitudes		Receives the magnitude of each common effect. Must have room for MAX_COMMON_EFFECTS.
+		 * @param durations			Receives the duration of each common effect. Must have room for MAX_COMMON_EFFECTS.
+		 * @param classes			Receives the classes of the potion.
+		 * @returns					The number of effects, which is 0 if the recipe doesn't have at least 2 unique ingredients that exist in the registry.
+		 */
+		static size_t evaluate(RegistryIndex const& index, std::span<const IngredientID> ingredients, const float coreMultiplier, EffectID* effectIDs, float* magnitudes, unsigned* durations, EPotionClass& classes)
+		{
+			classes = EPotionClass::None;
+
+			const auto& ingredientCount{ index.GetRegistry().size() };
+			bool valid{ ingredients.size() >= 2 };
+			for (size_t a{ 0 }; valid && a < ingredients.size(); ++a) {
+				valid = ingredients[a] < ingredientCount;
+				for (size_t b{ 0 }; valid && b < a; ++b)
+					valid = ingredients[a] != ingredients[b];
+			}
+			if (!valid) return 0;
+
+			const auto& common{ get_common_effects(index, ingredients) };
+			size_t strongest{ MAX_COMMON_EFFECTS };
+			for (size_t e{ 0 }; e < common.size(); ++e) {
+				const auto& it{ common[e] };
+				const auto& effectID{ index.GetEffectIDs(ingredients[it.ingredient])[it.slot] };
+				const auto& traits{ index.GetTraits(effectID) };
+				auto magnitude{ it.magnitude };
+				unsigned duration{ it.duration };
+				if (traits.durationBased)
+					duration = $c(unsigned, std::round(magnitude * coreMultiplier));
+				else
+					magnitude = std::round(magnitude * coreMultiplier);
+
+				effectIDs[e] = effectID;
+				magnitudes[e] = magnitude;
+				durations[e] = duration;
+				classes |= traits.classes;
+				if (strongest == MAX_COMMON_EFFECTS || magnitude > magnitudes[strongest])
+					strongest = e;
+			}
+			if (strongest != MAX_COMMON_EFFECTS && (index.GetTraits(effectIDs[strongest]).classes & EPotionClass::Harmful) != EPotionClass::None)
+				classes |= EPotionClass::Poison;
+			return common.size();
+		}
+		/**
+		 * @brief					Fills a batch with the recipes' effects after applying the core alchemy formula, without any perks.
+		 * @param coreMultiplier	The multiplier of the core alchemy formula, from AlchemyCoreFormula::GetMultiplier.
+		 */
+		void build_many(std::span<const Recipe> recipes, PotionBatch& batch, const float coreMultiplier) const
+		{
+			const auto& index{ *batch.index };
+			batch.resize(recipes.size());
+			// unused effect slots must be zero so that PotionCalculator can scale whole rows
+			std::fill(batch.magnitudes.begin(), batch.magnitudes.end(), 0.0f);
+
+			for (size_t i{ 0 }; i < recipes.size(); ++i) {
+				const auto offset{ i * MAX_COMMON_EFFECTS };
+				batch.recipes[i] = recipes[i];
+				const auto count{ evaluate(index, recipes[i].GetIngredients(), coreMultiplier, batch.effectIDs.data() + offset, batch.magnitudes.data() + offset, batch.durations.data() + offset, batch.classes[i]) };
+				batch.effectCounts[i] = $c(std::uint8_t, count);
+				batch.valid[i] = count != 0;
+			}
+		}
+		/// @brief	Evaluates a single recipe into a PotionHandle, without any perks.
+		static PotionHandle evaluate_handle(RegistryIndex const& index, Recipe const& recipe, const float coreMultiplier)
+		{
+			PotionHandle potion{ index, recipe };
+			potion.count = $c(std::uint8_t, evaluate(index, recipe.GetIngredients(), coreMultiplier, potion.effectIDs.data(), potion.magnitudes.data(), potion.durations.data(), potion.classes));
+			return potion;
+		}
 
+	public:
 		PotionBuilder(AlchemyCoreFormula const& coreFormula) : coreFormula{ coreFormula } {}
 		PotionBuilder(AlchemyCoreGameSettings const& coreGameSettings) : coreFormula{ coreGameSettings } {}
 
@@ -74,27 +148,91 @@ namespace alchlib2 {
 		}
 		[[nodiscard]] Potion Build(std::vector<Ingredient> const& ingredients, std::vector<Perk> const& perks) const
 		{
-			auto common{ get_common_effects(ingredients) };
-			for (auto& effect : common) {
-				if (effect.HasAnyKeyword(keywords::MagicAlchDurationBased))
-					effect.duration = std::round(coreFormula.GetResult(effect.magnitude));
-				else
-					effect.magnitude = std::round(coreFormula.GetResult(effect.magnitude));
-
-				for (const auto& it : perks)
-					it.ApplyToEffect(effect);
-			}
-			Potion p{ GetNameFromEffects(common), common };
-
-			for (const auto& it : perks)
-				it.ApplyToPotion(p);
-
-			return p;
+			return materialize(get_common_effects(ingredients), [&ingredients](CommonEffect const& it) -> const Effect& {
+				return ingredients[it.ingredient].effects[it.slot];
+			}, perks);
+		}
+		/**
+		 * @brief				Builds a potion from indexed ingredients, without copying them.
+		 * @param index			The index of the registry that the ingredients belong to.
+		 * @param ingredients	The IDs of the ingredients to combine.
+		 * @param perks			The perks to apply to the potion.
+		 */
+		[[nodiscard]] Potion Build(RegistryIndex const& index, std::span<const IngredientID> ingredients, std::vector<Perk> const& perks) const
+		{
+			return materialize(get_common_effects(index, ingredients), [&index, &ingredients](CommonEffect const& it) -> const Effect& {
+				return index.GetIngredient(ingredients[it.ingredient]).effects[it.slot];
+			}, perks);
+		}
+		/// @brief	Builds a potion, applying perks with a static pipeline instead of virtual calls.
+		template<typename... TPerks>
+		[[nodiscard]] Potion Build(std::vector<Ingredient> const& ingredients, PerkPipeline<TPerks...> const& perks) const
+		{
+			return materialize(get_common_effects(ingredients), [&ingredients](CommonEffect const& it) -> const Effect& {
+				return ingredients[it.ingredient].effects[it.slot];
+			}, perks);
+		}
+		/// @brief	Builds a potion from indexed ingredients, applying perks with a static pipeline instead of virtual calls.
+		template<typename... TPerks>
+		[[nodiscard]] Potion Build(RegistryIndex const& index, std::span<const IngredientID> ingredients, PerkPipeline<TPerks...> const& perks) const
+		{
+			return materialize(get_common_effects(index, ingredients), [&index, &ingredients](CommonEffect const& it) -> const Effect& {
+				return index.GetIngredient(ingredients[it.ingredient]).effects[it.slot];
+			}, perks);
 		}
 		template<var::any_same_or_convertible<Perk>... TPerks>
 		[[nodiscard]] Potion Build(std::vector<Ingredient> const& ingredients, TPerks&&... perks) const
 		{
 			return Build(ingredients, { std::forward<TPerks>(perks)... });
 		}
+
+		/**
+		 * @brief			Evaluates many recipes at once without creating any Potion objects, for analyzing large numbers of recipes.
+		 *					The core alchemy formula is applied to each effect, but perks are not; use Build() to get the final Potion of a recipe.
+		 * @param recipes	The recipes to evaluate.
+		 * @param batch		The batch to fill with the results, in the same order as recipes. Any previous contents are replaced.
+		 */
+		void BuildMany(std::span<const Recipe> recipes, PotionBatch& batch) const
+		{
+			build_many(recipes, batch, coreFormula.GetMultiplier());
+		}
+		/**
+		 * @brief				Evaluates many recipes at once using a compiled calculator, applying both the core alchemy formula & perks.
+		 *						The calculator's game settings are used instead of this builder's.
+		 * @param recipes		The recipes to evaluate.
+		 * @param batch			The batch to fill with the results, in the same order as recipes. Any previous contents are replaced.
+		 * @param calculator	The compiled game settings & perks to apply.
+		 */
+		void BuildMany(std::span<const Recipe> recipes, PotionBatch& batch, PotionCalculator const& calculator) const
+		{
+			build_many(recipes, batch, calculator.GetCoreMultiplier());
+			calculator.ApplyPerks(batch);
+		}
+
+		/**
+		 * @brief			Evaluates a single recipe without creating a Potion object or generating its name.
+		 *					The core alchemy formula is applied to each effect, but perks are not.
+		 * @param index		The index of the registry that the recipe refers to.
+		 * @param recipe	The recipe to evaluate.
+		 * @returns			A PotionHandle that can be materialized into a Potion when it's needed.
+		 */
+		[[nodiscard]] PotionHandle Evaluate(RegistryIndex const& index, Recipe const& recipe) const
+		{
+			return evaluate_handle(index, recipe, coreFormula.GetMultiplier());
+		}
+		/**
+		 * @brief				Evaluates a single recipe using a compiled calculator, without creating a Potion object or generating its name.
+		 *						The calculator's game settings are used instead of this builder's.
+		 * @param index			The index of the registry that the recipe refers to.
+		 * @param recipe		The recipe to evaluate.
+		 * @param calculator	The compiled game settings & perks to apply.
+		 * @returns				A PotionHandle that can be materialized into a Potion when it's needed.
+		 */
+		[[nodiscard]] PotionHandle Evaluate(RegistryIndex const& index, Recipe const& recipe, PotionCalculator const& calculator) const
+		{
+			auto potion{ evaluate_handle(index, recipe, calculator.GetCoreMultiplier()) };
+			calculator.ApplyPerks(potion);
+			return potion;
+		}
 	};
 }
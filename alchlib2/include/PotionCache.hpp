@@ -0,0 +1,253 @@
+#pragma once
+#include "Fingerprint.hpp"
+#include "PotionBuilder.hpp"
+
+#include <make_exception.hpp>
+#include <fileio.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <list>
+#include <optional>
+#include <unordered_map>
+
+namespace alchlib2 {
+	/**
+	 * @brief		Gets a hash of everything about an effect that potions depend on: its name, every one of its traits & its base cost.
+	 * @param index	The index of the registry.
+	 * @param id	The effect.
+	 * @returns		The fingerprint of the effect.
+	 */
+	inline std::uint64_t get_effect_fingerprint(RegistryIndex const& index, const EffectID id)
+	{
+		// the traits are hashed one member at a time, since their padding bytes aren't guaranteed to be zero
+		const auto& traits{ index.GetTraits(id) };
+		return Fingerprint{}.add(std::string_view{ index.GetEffectName(id) }).add(traits.durationBased).add(traits.classes).add(traits.disposition).add(index.GetBaseCost(id));
+	}
+
+	/**
+	 * @brief		Gets a hash of every ingredient in a registry & the effect stats that potions are built from.
+	 *				It changes whenever an IngredientID or EffectID would refer to something else, so it's used to tell if saved results are stale.
+	 * @param index	The index of the registry.
+	 * @returns		The fingerprint of the registry.
+	 */
+	inline std::uint64_t get_registry_fingerprint(RegistryIndex const& index)
+	{
+		Fingerprint fingerprint;
+		const auto ingredientCount{ index.GetRegistry().size() };
+		fingerprint.add(ingredientCount).add(index.GetEffectCount());
+		for (IngredientID id{ 0 }; id < ingredientCount; ++id) {
+			fingerprint.add(std::string_view{ index.GetIngredient(id).name });
+			fingerprint.add(index.GetEffectIDs(id)).add(index.GetMagnitudes(id)).add(index.GetDurations(id));
+		}
+		for (EffectID id{ 0 }; id < index.GetEffectCount(); ++id)
+			fingerprint.add(get_effect_fingerprint(index, id));
+		return fingerprint;
+	}
+
+	/**
+	 * @brief		A bounded cache of evaluated potions, so that repeated queries don't rebuild the same recipes.
+	 *				Potions are keyed by their ingredients in ascending order & the fingerprint of the calculator that evaluated
+	 *				 them, so the same recipe in a different order is a hit, while different game settings or perks are a miss.
+	 *				When the cache is full, the least recently used potion is evicted.
+	 *				Caches can be saved to disk & read back in later sessions; saved potions are discarded if the registry changed.
+	 *				The cache isn't thread-safe, & the index must outlive it.
+	 */
+	class PotionCache {
+		struct Key {
+			/// @brief	The ingredients in ascending order. Unused slots are NullIngredientID.
+			std::array<IngredientID, MAX_POTION_INGREDIENTS> ingredients;
+			/// @brief	The fingerprint of the calculator.
+			std::uint64_t fingerprint;
+
+			CONSTEXPR bool operator==(Key const&) const noexcept = default;
+		};
+		struct KeyHash {
+			size_t operator()(Key const& key) const noexcept
+			{
+				return $c(size_t, Fingerprint{}.add(std::span<const IngredientID>{ key.ingredients }).add(key.fingerprint).get());
+			}
+		};
+		struct Entry {
+			Key key;
+			PotionHandle potion;
+		};
+
+		const RegistryIndex* index;
+		size_t capacity;
+		/// @brief	Ordered from the most recently used to the least recently used.
+		std::list<Entry> entries;
+		std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> lookup;
+		size_t hits{ 0 };
+		size_t misses{ 0 };
+
+		/// @brief	Gets the canonical version of a recipe, with its ingredients in ascending order.
+		static Recipe get_canonical(Recipe recipe) noexcept
+		{
+			std::sort(recipe.ingredients.begin(), recipe.ingredients.begin() + recipe.count);
+			return recipe;
+		}
+
+		/// @brief	Removes the least recently used potions until the cache fits its capacity.
+		void evict() noexcept
+		{
+			while (entries.size() > capacity) {
+				lookup.erase(entries.back().key);
+				entries.pop_back();
+			}
+		}
+
+		/// @brief	Adds a potion as the most recently used one, replacing any potion with the same key.
+		void insert(Key const& key, PotionHandle const& potion)
+		{
+			if (const auto& it{ lookup.find(key) }; it != lookup.end()) {
+				entries.erase(it->second);
+				lookup.erase(it);
+			}
+			entries.emplace_front(Entry{ key, potion });
+			lookup.emplace(key, entries.begin());
+			evict();
+		}
+
+	public:
+		/**
+		 * @brief			Creates an empty cache.
+		 * @param index		The index of the registry that recipes refer to.
+		 * @param capacity	The maximum number of potions to keep.
+		 */
+		PotionCache(RegistryIndex const& index, const size_t capacity = 65536) : index{ &index }, capacity{ capacity } {}
+
+		/**
+		 * @brief			Reads a cache that was saved by WriteTo.
+		 * @param path		The path of the file. If it doesn't exist, an empty cache is returned.
+		 * @param index		The index of the registry that recipes refer to.
+		 * @param capacity	The maximum number of potions to keep. When the file has more, the least recently used ones are discarded.
+		 * @returns			The cache, which is empty when the file was saved with a different registry.
+		 */
+		[[nodiscard]] static PotionCache ReadFrom(std::filesystem::path const& path, RegistryIndex const& index, const size_t capacity = 65536)
+		{
+			PotionCache cache{ index, capacity };
+			if (!file::exists(path))
+				return cache;
+
+			nlohmann::json j;
+			file::read(path) >> j;
+			if (!j.is_object() || !j.contains("registry") || !j.contains("potions"))
+				throw make_exception("Potion cache file ", path, " is invalid!");
+			if (j["registry"].get<std::uint64_t>() != get_registry_fingerprint(index))
+				return cache;
+
+			// potions are saved from the most recently used to the least, so they're inserted in reverse
+			const auto& potions{ j["potions"] };
+			for (auto it{ potions.rbegin() }; it != potions.rend(); ++it) {
+				const auto& ingredients{ (*it)["ingredients"] };
+				const auto& effects{ (*it)["effects"] };
+				if (ingredients.size() > MAX_POTION_INGREDIENTS || effects.size() > MAX_COMMON_EFFECTS)
+					throw make_exception("Potion cache file ", path, " contains an invalid potion!");
+
+				Recipe recipe;
+				for (const auto& id : ingredients) {
+					if (id.get<IngredientID>() >= index.GetRegistry().size())
+						throw make_exception("Potion cache file ", path, " contains an invalid ingredient ID!");
+					recipe.ingredients[recipe.count++] = id.get<IngredientID>();
+				}
+				recipe = get_canonical(recipe);
+
+				PotionHandle potion{ index, recipe };
+				potion.classes = $c(EPotionClass, (*it)["classes"].get<unsigned>());
+				for (const auto& effect : effects) {
+					if (effect[0].get<EffectID>() >= index.GetEffectCount())
+						throw make_exception("Potion cache file ", path, " contains an invalid effect ID!");
+					potion.effectIDs[potion.count] = effect[0].get<EffectID>();
+					potion.magnitudes[potion.count] = effect[1].get<float>();
+					potion.durations[potion.count] = effect[2].get<unsigned>();
+					++potion.count;
+				}
+				cache.insert(Key{ recipe.ingredients, (*it)["fingerprint"].get<std::uint64_t>() }, potion);
+			}
+			return cache;
+		}
+		/**
+		 * @brief			Saves a cache, so that it can be read by ReadFrom in a later session.
+		 * @param path		The path of the file.
+		 * @param cache		The cache to save. Hit & miss counters aren't saved.
+		 * @returns			True when the file was written successfully.
+		 */
+		static bool WriteTo(std::filesystem::path const& path, PotionCache const& cache)
+		{
+			nlohmann::json potions = nlohmann::json::array();
+			for (const auto& [key, potion] : cache.entries) {
+				nlohmann::json effects = nlohmann::json::array();
+				for (size_t e{ 0 }; e < potion.GetEffectCount(); ++e)
+					effects.push_back({ potion.GetEffectIDs()[e], potion.GetMagnitudes()[e], potion.GetDurations()[e] });
+				const auto& ingredients{ potion.GetRecipe().GetIngredients() };
+				potions.push_back({
+					{ "fingerprint", key.fingerprint },
+					{ "ingredients", std::vector<IngredientID>{ ingredients.begin(), ingredients.end() } },
+					{ "classes", $c(unsigned, potion.GetClass()) },
+					{ "effects", std::move(effects) },
+				});
+			}
+			return file::write(path, nlohmann::json{ { "registry", get_registry_fingerprint(*cache.index) }, { "potions", std::move(potions) } });
+		}
+
+		CONSTEXPR size_t size() const noexcept { return entries.size(); }
+		CONSTEXPR size_t GetCapacity() const noexcept { return capacity; }
+		/// @brief	Changes the maximum number of potions to keep, evicting the least recently used ones if there are too many.
+		void SetCapacity(const size_t newCapacity) noexcept
+		{
+			capacity = newCapacity;
+			evict();
+		}
+		/// @brief	Removes every potion. The hit & miss counters aren't reset.
+		void Clear() noexcept
+		{
+			entries.clear();
+			lookup.clear();
+		}
+
+		/// @brief	Gets the number of lookups that found a potion.
+		CONSTEXPR size_t GetHits() const noexcept { return hits; }
+		/// @brief	Gets the number of lookups that didn't find a potion.
+		CONSTEXPR size_t GetMisses() const noexcept { return misses; }
+		CONSTEXPR void ResetCounters() noexcept { hits = misses = 0; }
+
+		/**
+		 * @brief				Finds a potion that was evaluated with the same calculator, & marks it as the most recently used one.
+		 * @param recipe		The recipe to find. The order of its ingredients doesn't matter.
+		 * @param calculator	The calculator that the potion must have been evaluated with.
+		 * @returns				The potion, or std::nullopt if it isn't cached. The potion's recipe is in canonical order.
+		 */
+		std::optional<PotionHandle> Find(Recipe const& recipe, PotionCalculator const& calculator)
+		{
+			const auto& it{ lookup.find(Key{ get_canonical(recipe).ingredients, calculator.GetFingerprint() }) };
+			if (it == lookup.end()) {
+				++misses;
+				return std::nullopt;
+			}
+			++hits;
+			entries.splice(entries.begin(), entries, it->second);
+			return it->second->potion;
+		}
+
+		/**
+		 * @brief				Gets a cached potion, or evaluates & caches it if it isn't cached.
+		 * @param builder		The builder to evaluate recipes with.
+		 * @param calculator	The compiled game settings & perks to apply.
+		 * @param recipe		The recipe to evaluate. The order of its ingredients doesn't matter.
+		 * @returns				The potion. Its recipe & effects are always in canonical order, whether it was cached or not.
+		 */
+		PotionHandle Evaluate(PotionBuilder const& builder, PotionCalculator const& calculator, Recipe const& recipe)
+		{
+			if (auto potion{ Find(recipe, calculator) }; potion.has_value())
+				return std::move(potion.value());
+			const auto& canonical{ get_canonical(recipe) };
+			auto potion{ builder.Evaluate(*index, canonical, calculator) };
+			if (capacity != 0)
+				insert(Key{ canonical.ingredients, calculator.GetFingerprint() }, potion);
+			return potion;
+		}
+	};
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include "Fingerprint.hpp"
+#include "Formula.hpp"
+#include "PotionBatch.hpp"
+#include "PotionHandle.hpp"
+
+#include "perks/VanillaPerks.h"
+
+#include <algorithm>
+#include <array>
+
+namespace alchlib2 {
+	/**
+	 * @brief		Game settings & vanilla perks compiled into plain multipliers, for evaluating large numbers of potions.
+	 *				The core alchemy formula becomes one multiplier for every effect, and the potion-wide perks become one
+	 *				 magnitude multiplier for each combination of EPotionClass flags, so applying them is a table lookup & a multiply.
+	 *				The calculator copies the game settings & perks, so it must be recreated when either of them changes.
+	 */
+	class PotionCalculator {
+		/// @brief	The number of distinct EPotionClass values.
+		static constexpr const size_t CLASS_COUNT{ 16 };
+
+		float coreMultiplier;
+		/// @brief	Indexed by EPotionClass.
+		std::array<float, CLASS_COUNT> magnitudeMultipliers;
+		bool purity;
+		std::uint64_t fingerprint;
+
+		/**
+		 * @brief				Removes the effects that the Purity perk removes from a single potion, keeping the rest in order.
+		 *						Removing effects never changes the strongest effect, so the potion stays a poison (or not).
+		 * @param index			The index of the registry that the effects belong to.
+		 * @param classes		The classes of the potion, which are updated to match the remaining effects.
+		 * @param count			The number of effects in the potion.
+		 * @param effectIDs		The EffectIDs of the potion's effects.
+		 * @param magnitudes	The magnitudes of the potion's effects. Removed slots are zeroed.
+		 * @param durations		The durations of the potion's effects.
+		 * @returns				The number of remaining effects.
+		 */
+		static size_t apply_purity(RegistryIndex const& index, EPotionClass& classes, const size_t count, EffectID* effectIDs, float* magnitudes, unsigned* durations) noexcept
+		{
+			const auto removed{ (classes & EPotionClass::Poison) != EPotionClass::None ? EPotionClass::Beneficial : EPotionClass::Harmful };
+			if ((classes & removed) == EPotionClass::None)
+				return count;
+
+			size_t kept{ 0 };
+			EPotionClass keptClasses{ classes & EPotionClass::Poison };
+			for (size_t e{ 0 }; e < count; ++e) {
+				const auto& traits{ index.GetTraits(effectIDs[e]) };
+				if ((traits.classes & removed) != EPotionClass::None)
+					continue;
+				effectIDs[kept] = effectIDs[e];
+				magnitudes[kept] = magnitudes[e];
+				durations[kept] = durations[e];
+				keptClasses |= traits.classes;
+				++kept;
+			}
+			std::fill(magnitudes + kept, magnitudes + count, 0.0f);
+			classes = keptClasses;
+			return kept;
+		}
+
+	public:
+		/**
+		 * @brief					Compiles the given game settings & perks.
+		 * @param coreGameSettings	The game settings used by the core alchemy formula.
+		 * @param perks				The perks to apply to potions. Only enabled perks are compiled.
+		 */
+		PotionCalculator(AlchemyCoreGameSettings const& coreGameSettings, perks::VanillaPerks const& perks = {}) :
+			coreMultiplier{ AlchemyCoreFormula{ coreGameSettings }.GetMultiplier() },
+			magnitudeMultipliers{},
+			purity{ perks.Purity.enable }
+		{
+			// these conditions mirror the ApplyToPotion methods of each perk, in the order that VanillaPerks applies them
+			for (size_t i{ 0 }; i < CLASS_COUNT; ++i) {
+				const auto classes{ $c(EPotionClass, i) };
+				const bool isPoison{ (classes & EPotionClass::Poison) != EPotionClass::None };
+				float multiplier{ 1.0f };
+				if (perks.Alchemist.enable)
+					multiplier *= 0.2f * $c(float, perks.Alchemist.rank);
+				if (perks.Physician.enable && (classes & EPotionClass::Restore) != EPotionClass::None)
+					multiplier *= 1.25f;
+				if (perks.Benefactor.enable && (classes & EPotionClass::Beneficial) != EPotionClass::None && !isPoison)
+					multiplier *= 1.25f;
+				if (perks.Poisoner.enable && (classes & EPotionClass::Harmful) != EPotionClass::None && isPoison)
+					multiplier *= 1.25f;
+				magnitudeMultipliers[i] = multiplier;
+			}
+
+			// everything that affects the results is compiled into these members, so they're all that needs to be compared
+			fingerprint = Fingerprint{}.add(coreMultiplier).add(std::span<const float>{ magnitudeMultipliers }).add(purity);
+		}
+
+		/// @brief	Gets the multiplier of the core alchemy formula.
+		CONSTEXPR float GetCoreMultiplier() const noexcept { return coreMultiplier; }
+		/// @brief	Gets the multiplier that perks apply to the magnitudes of a potion with the given classes.
+		CONSTEXPR float GetMagnitudeMultiplier(const EPotionClass classes) const noexcept { return magnitudeMultipliers[$c(size_t, classes)]; }
+		/// @brief	Gets the largest multiplier that perks can apply to the magnitudes of any potion.
+		CONSTEXPR float GetMaxMagnitudeMultiplier() const noexcept { return *std::max_element(magnitudeMultipliers.begin(), magnitudeMultipliers.end()); }
+		/// @brief	Checks if the Purity perk is enabled, which removes harmful effects from potions & beneficial effects from poisons.
+		CONSTEXPR bool IsPurityEnabled() const noexcept { return purity; }
+		/// @brief	Gets a hash of the compiled game settings & perks. Calculators with the same fingerprint produce the same potions.
+		CONSTEXPR std::uint64_t GetFingerprint() const noexcept { return fingerprint; }
+
+		/// @brief	Applies the core alchemy formula to a base magnitude or duration. This is equivalent to AlchemyCoreFormula::GetResult, rounded.
+		CONSTEXPR float GetBase(const float base_val) const noexcept { return std::round(base_val * coreMultiplier); }
+
+		/**
+		 * @brief		Applies the compiled perks to every potion in a batch that was filled by PotionBuilder::BuildMany.
+		 *				Potion names are generated from the batch, so they reflect any effects removed by Purity.
+		 * @param batch	The batch to modify.
+		 */
+		void ApplyPerks(PotionBatch& batch) const noexcept
+		{
+			// unused effect slots are zeroed by BuildMany, so every row can be scaled in full, which lets this loop vectorize
+			for (size_t i{ 0 }; i < batch.size(); ++i) {
+				const auto multiplier{ GetMagnitudeMultiplier(batch.classes[i]) };
+				auto* magnitudes{ batch.magnitudes.data() + i * MAX_COMMON_EFFECTS };
+				for (size_t e{ 0 }; e < MAX_COMMON_EFFECTS; ++e)
+					magnitudes[e] *= multiplier;
+			}
+
+			if (!purity) return;
+
+			const auto& index{ batch.GetIndex() };
+			for (size_t i{ 0 }; i < batch.size(); ++i) {
+				const auto offset{ i * MAX_COMMON_EFFECTS };
+				const auto kept{ apply_purity(index, batch.classes[i], batch.effectCounts[i], batch.effectIDs.data() + offset, batch.magnitudes.data() + offset, batch.durations.data() + offset) };
+				batch.effectCounts[i] = $c(std::uint8_t, kept);
+				batch.valid[i] = kept != 0;
+			}
+		}
+		/**
+		 * @brief			Applies the compiled perks to a potion that was evaluated by PotionBuilder::Evaluate.
+		 * @param potion	The potion to modify.
+		 */
+		void ApplyPerks(PotionHandle& potion) const noexcept
+		{
+			const auto multiplier{ GetMagnitudeMultiplier(potion.classes) };
+			for (size_t e{ 0 }; e < potion.count; ++e)
+				potion.magnitudes[e] *= multiplier;
+
+			if (purity)
+				potion.count = $c(std::uint8_t, apply_purity(*potion.index, potion.classes, potion.count, potion.effectIDs.data(), potion.magnitudes.data(), potion.durations.data()));
+		}
+	};
+}
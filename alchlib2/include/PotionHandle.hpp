@@ -0,0 +1,103 @@
+#pragma once
+#include "Potion.hpp"
+#include "PotionBatch.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace alchlib2 {
+	/**
+	 * @brief		An evaluated potion that only holds its recipe, EffectIDs & stats, so creating & copying it never allocates.
+	 *				The name & Potion object are generated when GetName() or Materialize() is called, so candidates can be
+	 *				 filtered & ranked without building strings for the ones that are discarded.
+	 *				Effect names & keywords are taken from the first occurrence of each effect in the registry.
+	 *				The index must outlive the handle.
+	 */
+	class PotionHandle {
+		friend struct PotionBuilder;
+		friend class PotionCalculator;
+		friend class PotionCache;
+		friend class SweepResult;
+		friend class RecipeDatabase;
+
+		const RegistryIndex* index;
+		Recipe recipe;
+		EPotionClass classes;
+		std::uint8_t count;
+		std::array<EffectID, MAX_COMMON_EFFECTS> effectIDs;
+		std::array<float, MAX_COMMON_EFFECTS> magnitudes;
+		std::array<unsigned, MAX_COMMON_EFFECTS> durations;
+
+	public:
+		/**
+		 * @brief			Creates a handle without any effects.
+		 * @param index		The index of the registry that the recipe refers to.
+		 * @param recipe	The recipe of the potion.
+		 */
+		CONSTEXPR PotionHandle(RegistryIndex const& index, Recipe const& recipe = {}) :
+			index{ &index },
+			recipe{ recipe },
+			classes{ EPotionClass::None },
+			count{ 0 },
+			effectIDs{},
+			magnitudes{},
+			durations{}
+		{}
+		/**
+		 * @brief		Copies a potion out of a batch, so that it can be kept after the batch is refilled.
+		 * @param batch	The batch that contains the potion.
+		 * @param i		The position of the potion in the batch.
+		 */
+		CONSTEXPR PotionHandle(PotionBatch const& batch, const size_t i) : PotionHandle(batch.GetIndex(), batch.GetRecipe(i))
+		{
+			classes = batch.GetClass(i);
+			count = $c(std::uint8_t, batch.GetEffectCount(i));
+			std::ranges::copy(batch.GetEffectIDs(i), effectIDs.begin());
+			std::ranges::copy(batch.GetMagnitudes(i), magnitudes.begin());
+			std::ranges::copy(batch.GetDurations(i), durations.begin());
+		}
+
+		/// @brief	Gets the index that the recipe refers to.
+		CONSTEXPR const RegistryIndex& GetIndex() const noexcept { return *index; }
+		CONSTEXPR const Recipe& GetRecipe() const noexcept { return recipe; }
+		/// @brief	Checks if the potion has at least one effect.
+		CONSTEXPR bool IsValid() const noexcept { return count != 0; }
+		CONSTEXPR EPotionClass GetClass() const noexcept { return classes; }
+		CONSTEXPR bool IsPoison() const noexcept { return (classes & EPotionClass::Poison) != EPotionClass::None; }
+
+		CONSTEXPR size_t GetEffectCount() const noexcept { return count; }
+		CONSTEXPR std::span<const EffectID> GetEffectIDs() const noexcept { return{ effectIDs.data(), count }; }
+		CONSTEXPR std::span<const float> GetMagnitudes() const noexcept { return{ magnitudes.data(), count }; }
+		CONSTEXPR std::span<const unsigned> GetDurations() const noexcept { return{ durations.data(), count }; }
+
+		/// @brief	Gets the position of the strongest effect in the potion, or MAX_COMMON_EFFECTS if it doesn't have any effects.
+		CONSTEXPR size_t GetStrongestEffect() const noexcept
+		{
+			size_t strongest{ MAX_COMMON_EFFECTS };
+			for (size_t e{ 0 }; e < count; ++e)
+				if (strongest == MAX_COMMON_EFFECTS || magnitudes[e] > magnitudes[strongest])
+					strongest = e;
+			return strongest;
+		}
+
+		/// @brief	Generates the name of the potion from its effects after perks were applied, which is the same name that PotionBuilder::Build gives it.
+		std::string GetName() const
+		{
+			return get_potion_name(*index, GetEffectIDs(), GetMagnitudes());
+		}
+
+		/// @brief	Creates the full Potion object, including its name & a copy of each effect's keywords.
+		[[nodiscard]] Potion Materialize() const
+		{
+			Potion p;
+			p.name = GetName();
+			p.effects.reserve(count);
+			for (size_t e{ 0 }; e < count; ++e) {
+				auto& effect{ p.effects.emplace_back(index->GetEffect(effectIDs[e])) };
+				effect.magnitude = magnitudes[e];
+				effect.duration = durations[e];
+			}
+			return p;
+		}
+	};
+}
@@ -0,0 +1,268 @@
+#pragma once
+#include "PotionBuilder.hpp"
+#include "PotionValue.hpp"
+
+#include <make_exception.hpp>
+#include <str.hpp>
+
+#include <cmath>
+
+namespace alchlib2 {
+	/// @brief	A range of values for one of the game settings in AlchemyCoreGameSettings.
+	struct SweepAxis {
+		/// @brief	The name of the game setting, like "fAlchemyAV".
+		std::string setting;
+		float first;
+		float last;
+		float step{ 1.0f };
+
+		/// @brief	Gets the number of values in the range, including both ends.
+		size_t size() const noexcept { return $c(size_t, std::floor((last - first) / step + 1e-4f)) + 1; }
+		/// @brief	Gets every value in the range, from first to last.
+		std::vector<float> GetValues() const
+		{
+			std::vector<float> values(size());
+			for (size_t k{ 0 }; k < values.size(); ++k)
+				values[k] = first + step * $c(float, k);
+			return values;
+		}
+
+		/**
+		 * @brief		Gets the game setting that this axis changes.
+		 * @param gmst	The game settings to get it from.
+		 * @returns		A reference to the setting in gmst.
+		 */
+		GameSetting<float>& GetSetting(AlchemyCoreGameSettings& gmst) const
+		{
+			for (auto* candidate : { &gmst.fAlchemyIngredientInitMult, &gmst.fAlchemySkillFactor, &gmst.fAlchemyAV, &gmst.fAlchemyMod })
+				if (str::tolower(candidate->name) == str::tolower(setting))
+					return *candidate;
+			throw make_exception("'", setting, "' isn't a game setting that affects potions! (Expected fAlchemyIngredientInitMult, fAlchemySkillFactor, fAlchemyAV or fAlchemyMod)");
+		}
+
+		/**
+		 * @brief		Parses an axis from a string like "fAlchemyAV=15..100", with an optional step like "fAlchemyAV=15..100:5".
+		 * @param s		The string to parse.
+		 * @returns		The SweepAxis.
+		 */
+		static SweepAxis Parse(const std::string& s)
+		{
+			const auto& eq{ s.find('=') };
+			const auto& dots{ s.find("..", eq == std::string::npos ? 0 : eq) };
+			if (eq == std::string::npos || dots == std::string::npos)
+				throw make_exception("Invalid sweep '", s, "'! (Expected a setting & range like fAlchemyAV=15..100)");
+			const auto& colon{ s.find(':', dots) };
+
+			SweepAxis axis;
+			axis.setting = s.substr(0, eq);
+			try {
+				axis.first = std::stof(s.substr(eq + 1, dots - eq - 1));
+				axis.last = std::stof(s.substr(dots + 2, colon == std::string::npos ? std::string::npos : colon - dots - 2));
+				if (colon != std::string::npos)
+					axis.step = std::stof(s.substr(colon + 1));
+			} catch (const std::exception&) {
+				throw make_exception("Invalid sweep '", s, "'! (Expected numbers like fAlchemyAV=15..100 or fAlchemyAV=15..100:5)");
+			}
+			if (!(axis.step > 0.0f) || !(axis.first <= axis.last))
+				throw make_exception("Invalid sweep '", s, "'! (The range must be ascending & the step must be positive)");
+			if (axis.size() > 100000)
+				throw make_exception("Invalid sweep '", s, "'! (It has more than 100000 values)");
+			AlchemyCoreGameSettings gmst;
+			axis.GetSetting(gmst);
+			return axis;
+		}
+	};
+
+	/**
+	 * @brief		The stats of a single recipe at every value of a SweepAxis, stored effect by effect so that each effect
+	 *				 can be scaled for the whole axis in one loop.
+	 *				The index must outlive the result.
+	 */
+	class SweepResult {
+		friend class PotionSweep;
+
+		const RegistryIndex* index;
+		Recipe recipe;
+		size_t points;
+		/// @brief	The common effects of the recipe, before the Purity perk removes any of them.
+		std::vector<EffectID> effectIDs;
+		/// @brief	Indexed by (effect * points + point).
+		std::vector<float> magnitudes;
+		/// @brief	Indexed by (effect * points + point).
+		std::vector<unsigned> durations;
+		/// @brief	The classes of the potion at each point.
+		std::vector<EPotionClass> classes;
+		/// @brief	A bitmask of the effects that the potion has at each point, after the Purity perk.
+		std::vector<std::uint8_t> kept;
+
+		SweepResult(RegistryIndex const& index, Recipe const& recipe, const size_t effectCount, const size_t points) :
+			index{ &index },
+			recipe{ recipe },
+			points{ points },
+			effectIDs(effectCount),
+			magnitudes(effectCount * points),
+			durations(effectCount * points),
+			classes(points),
+			kept(points)
+		{}
+
+	public:
+		CONSTEXPR const Recipe& GetRecipe() const noexcept { return recipe; }
+		/// @brief	Gets the number of values on the axis.
+		CONSTEXPR size_t size() const noexcept { return points; }
+		/// @brief	Gets every effect that the potion has at any point, in the order that they appear.
+		CONSTEXPR std::span<const EffectID> GetEffectIDs() const noexcept { return effectIDs; }
+		/// @brief	Gets the magnitude of an effect at every point, where e is its position in GetEffectIDs().
+		CONSTEXPR std::span<const float> GetMagnitudes(const size_t e) const noexcept { return{ magnitudes.data() + e * points, points }; }
+		/// @brief	Gets the duration of an effect at every point, where e is its position in GetEffectIDs().
+		CONSTEXPR std::span<const unsigned> GetDurations(const size_t e) const noexcept { return{ durations.data() + e * points, points }; }
+		/// @brief	Checks if the potion has an effect at a point, where e is its position in GetEffectIDs().
+		CONSTEXPR bool HasEffect(const size_t e, const size_t point) const noexcept { return (kept[point] >> e) & 1; }
+
+		/**
+		 * @brief		Gets the potion at a single point, which is the same potion that PotionBuilder::Evaluate would create
+		 *				 with the settings of that point.
+		 * @param point	The position of the value on the axis.
+		 * @returns		A PotionHandle of the potion.
+		 */
+		PotionHandle GetPotion(const size_t point) const
+		{
+			PotionHandle potion{ *index, recipe };
+			potion.classes = classes[point];
+			for (size_t e{ 0 }; e < effectIDs.size(); ++e) {
+				if (!HasEffect(e, point))
+					continue;
+				potion.effectIDs[potion.count] = effectIDs[e];
+				potion.magnitudes[potion.count] = magnitudes[e * points + point];
+				potion.durations[potion.count] = durations[e * points + point];
+				++potion.count;
+			}
+			return potion;
+		}
+	};
+
+	/**
+	 * @brief		Evaluates recipes over a range of values of one game setting at once.
+	 *				The core alchemy formula is a product of per-setting factors that scales every effect by the same multiplier,
+	 *				 so the common effects of a recipe are found once, & only the multiplication, rounding & perks are repeated
+	 *				 for each value on the axis, in loops over the axis that the compiler can vectorize.
+	 */
+	class PotionSweep {
+		SweepAxis axis;
+		std::vector<float> values;
+		/// @brief	The multiplier of the core alchemy formula at each value.
+		std::vector<float> multipliers;
+		PotionCalculator calculator;
+
+	public:
+		/**
+		 * @brief					Compiles the core alchemy formula for every value on an axis.
+		 * @param axis				The game setting to change & its range.
+		 * @param coreGameSettings	The values of the other game settings.
+		 * @param perks				The perks to apply to potions.
+		 */
+		PotionSweep(SweepAxis const& axis, AlchemyCoreGameSettings const& coreGameSettings, perks::VanillaPerks const& perks = {}) :
+			axis{ axis },
+			values{ axis.GetValues() },
+			multipliers(values.size()),
+			calculator{ coreGameSettings, perks }
+		{
+			auto gmst{ coreGameSettings };
+			auto& setting{ axis.GetSetting(gmst) };
+			for (size_t k{ 0 }; k < values.size(); ++k) {
+				setting.value = values[k];
+				multipliers[k] = AlchemyCoreFormula{ gmst }.GetMultiplier();
+			}
+		}
+
+		CONSTEXPR const SweepAxis& GetAxis() const noexcept { return axis; }
+		/// @brief	Gets every value on the axis.
+		CONSTEXPR std::span<const float> GetValues() const noexcept { return values; }
+
+		/**
+		 * @brief			Evaluates a recipe at every value on the axis.
+		 * @param index		The index of the registry that the recipe refers to.
+		 * @param recipe	The recipe to evaluate.
+		 * @returns			The stats of the recipe at each value.
+		 */
+		SweepResult Evaluate(RegistryIndex const& index, Recipe const& recipe) const
+		{
+			const auto& ingredients{ recipe.GetIngredients() };
+			for (size_t a{ 0 }; a < ingredients.size(); ++a) {
+				if (ingredients[a] >= index.GetRegistry().size())
+					throw make_exception("Invalid ingredient ID ", ingredients[a], "! (The registry has ", index.GetRegistry().size(), " ingredients)");
+				for (size_t b{ 0 }; b < a; ++b)
+					if (ingredients[a] == ingredients[b])
+						throw make_exception("Recipes can't contain the same ingredient more than once!");
+			}
+
+			const auto& common{ ingredients.size() >= 2 ? get_common_effects(index, ingredients) : CommonEffectList{} };
+			const auto points{ values.size() };
+			SweepResult result{ index, recipe, common.size(), points };
+
+			// scale each effect across the whole axis
+			EPotionClass effectClasses{ EPotionClass::None };
+			for (size_t e{ 0 }; e < common.size(); ++e) {
+				const auto& it{ common[e] };
+				const auto& effectID{ index.GetEffectIDs(ingredients[it.ingredient])[it.slot] };
+				const auto& traits{ index.GetTraits(effectID) };
+				result.effectIDs[e] = effectID;
+				effectClasses |= traits.classes;
+
+				auto* magnitudes{ result.magnitudes.data() + e * points };
+				auto* durations{ result.durations.data() + e * points };
+				if (traits.durationBased) {
+					for (size_t k{ 0 }; k < points; ++k) {
+						magnitudes[k] = it.magnitude;
+						durations[k] = $c(unsigned, std::round(it.magnitude * multipliers[k]));
+					}
+				}
+				else {
+					for (size_t k{ 0 }; k < points; ++k) {
+						magnitudes[k] = std::round(it.magnitude * multipliers[k]);
+						durations[k] = it.duration;
+					}
+				}
+			}
+
+			// rounding can change which effect is the strongest, so the classes & perks are applied at each point
+			std::vector<float> perkMultipliers(points);
+			for (size_t k{ 0 }; k < points; ++k) {
+				size_t strongest{ MAX_COMMON_EFFECTS };
+				for (size_t e{ 0 }; e < common.size(); ++e)
+					if (strongest == MAX_COMMON_EFFECTS || result.magnitudes[e * points + k] > result.magnitudes[strongest * points + k])
+						strongest = e;
+				auto classes{ effectClasses };
+				if (strongest != MAX_COMMON_EFFECTS && (index.GetTraits(result.effectIDs[strongest]).classes & EPotionClass::Harmful) != EPotionClass::None)
+					classes |= EPotionClass::Poison;
+				result.classes[k] = classes;
+				result.kept[k] = $c(std::uint8_t, (1u << common.size()) - 1u);
+				perkMultipliers[k] = calculator.GetMagnitudeMultiplier(classes);
+			}
+			for (size_t e{ 0 }; e < common.size(); ++e) {
+				auto* magnitudes{ result.magnitudes.data() + e * points };
+				for (size_t k{ 0 }; k < points; ++k)
+					magnitudes[k] *= perkMultipliers[k];
+			}
+
+			if (calculator.IsPurityEnabled()) {
+				// this mirrors PotionCalculator::ApplyPerks, which removes the effects that don't match the potion's type
+				for (size_t k{ 0 }; k < points; ++k) {
+					const auto removed{ (result.classes[k] & EPotionClass::Poison) != EPotionClass::None ? EPotionClass::Beneficial : EPotionClass::Harmful };
+					if ((result.classes[k] & removed) == EPotionClass::None)
+						continue;
+					auto keptClasses{ result.classes[k] & EPotionClass::Poison };
+					for (size_t e{ 0 }; e < common.size(); ++e) {
+						const auto& traits{ index.GetTraits(result.effectIDs[e]) };
+						if ((traits.classes & removed) != EPotionClass::None)
+							result.kept[k] &= $c(std::uint8_t, ~(1u << e));
+						else
+							keptClasses |= traits.classes;
+					}
+					result.classes[k] = keptClasses;
+				}
+			}
+			return result;
+		}
+	};
+}
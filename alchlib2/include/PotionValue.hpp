@@ -0,0 +1,66 @@
+#pragma once
+#include "Potion.hpp"
+#include "PotionBatch.hpp"
+#include "PotionHandle.hpp"
+
+#include <cmath>
+#include <span>
+
+namespace alchlib2 {
+	/**
+	 * @brief			Calculates how much a single effect adds to the gold value of a potion, using the game's formula:
+	 *					 baseCost × magnitude^1.1 × (duration / 10)^1.1, where a magnitude or duration of 0 doesn't affect the result.
+	 * @param baseCost	The base cost of the effect.
+	 * @param magnitude	The final magnitude of the effect.
+	 * @param duration	The final duration of the effect, in seconds.
+	 * @returns			The unrounded value of the effect.
+	 */
+	inline float get_effect_value(const float baseCost, const float magnitude, const unsigned duration) noexcept
+	{
+		const auto magnitudeFactor{ magnitude > 0.0f ? std::pow(magnitude, 1.1f) : 1.0f };
+		const auto durationFactor{ duration > 0u ? std::pow($c(float, duration) / 10.0f, 1.1f) : 1.0f };
+		return baseCost * magnitudeFactor * durationFactor;
+	}
+
+	/**
+	 * @brief				Calculates the gold value of a potion from the columns of its effects.
+	 * @param baseCosts		The base costs of all effects, indexed by EffectID. See RegistryIndex::GetBaseCosts.
+	 * @param effectIDs		The EffectIDs of the potion's effects.
+	 * @param magnitudes	The magnitudes of the potion's effects, in the same order as effectIDs.
+	 * @param durations		The durations of the potion's effects, in the same order as effectIDs.
+	 * @returns				The sum of the values of each effect, rounded down.
+	 */
+	inline unsigned get_potion_value(std::span<const float> baseCosts, std::span<const EffectID> effectIDs, std::span<const float> magnitudes, std::span<const unsigned> durations) noexcept
+	{
+		float value{ 0.0f };
+		for (size_t e{ 0 }; e < effectIDs.size(); ++e)
+			value += get_effect_value(baseCosts[effectIDs[e]], magnitudes[e], durations[e]);
+		return $c(unsigned, value);
+	}
+	/// @brief	Calculates the gold value of a potion, using the base cost of each of its effects.
+	inline unsigned get_potion_value(Potion const& potion) noexcept
+	{
+		float value{ 0.0f };
+		for (const auto& effect : potion.effects)
+			value += get_effect_value(effect.baseCost, effect.magnitude, effect.duration);
+		return $c(unsigned, value);
+	}
+	/// @brief	Calculates the gold value of an evaluated potion, without materializing it.
+	inline unsigned get_potion_value(PotionHandle const& potion) noexcept
+	{
+		return get_potion_value(potion.GetIndex().GetBaseCosts(), potion.GetEffectIDs(), potion.GetMagnitudes(), potion.GetDurations());
+	}
+
+	/**
+	 * @brief			Calculates the gold value of every potion in a batch, reading its effect columns directly.
+	 * @param batch		A batch that was filled by PotionBuilder::BuildMany.
+	 * @param values	Receives the value of each potion, in the same order as the batch. Invalid recipes are worth 0.
+	 */
+	inline void get_potion_values(PotionBatch const& batch, std::vector<unsigned>& values)
+	{
+		const auto& baseCosts{ batch.GetIndex().GetBaseCosts() };
+		values.resize(batch.size());
+		for (size_t i{ 0 }; i < batch.size(); ++i)
+			values[i] = get_potion_value(baseCosts, batch.GetEffectIDs(i), batch.GetMagnitudes(i), batch.GetDurations(i));
+	}
+}
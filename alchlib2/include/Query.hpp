@@ -0,0 +1,505 @@
+#pragma once
+#include "RegistryIndex.hpp"
+#include "ResultSet.hpp"
+
+#include <make_exception.hpp>
+#include <strconv.hpp>
+
+#include <charconv>
+#include <cmath>
+#include <numeric>
+#include <ostream>
+
+namespace alchlib2 {
+	/**
+	 * @brief		A boolean query over the ingredients in a registry.
+	 *				Example:  effect:"Restore Health" AND NOT keyword:MagicAlchHarmful AND mag>=5
+	 *
+	 *				| Term               | Matches                                                              |
+	 *				| ------------------ | -------------------------------------------------------------------- |
+	 *				| name:<VALUE>       | Ingredients with a name that contains VALUE.                         |
+	 *				| effect:<VALUE>     | Ingredients with an effect name that contains VALUE.                 |
+	 *				| keyword:<VALUE>    | Ingredients with an effect that has a keyword name/formID like VALUE.|
+	 *				| <VALUE>            | Ingredients with a name or effect name that contains VALUE.          |
+	 *				| mag <OP> <NUMBER>  | Ingredients with any effect whose magnitude satisfies the comparison.|
+	 *				| dur <OP> <NUMBER>  | Ingredients with any effect whose duration satisfies the comparison. |
+	 *				| mag(<EFFECT>) ...  | Same as mag, but only considers effects with a name like EFFECT.     |
+	 *				| dur(<EFFECT>) ...  | Same as dur, but only considers effects with a name like EFFECT.     |
+	 *
+	 *				Using '=' instead of ':' requires an exact (case-insensitive) match.
+	 *				Terms can be combined with AND, OR, NOT & parentheses; adjacent terms are implicitly joined by AND.
+	 *				Queries are parsed once, then compiled against a RegistryIndex into a QueryPlan that can be executed repeatedly.
+	 */
+	struct Query {
+		enum class NodeType : std::uint8_t {
+			And,
+			Or,
+			Not,
+			/// @brief	Ingredient name or effect name
+			Any,
+			Name,
+			Effect,
+			Keyword,
+			Magnitude,
+			Duration,
+		};
+		enum class Comparison : std::uint8_t {
+			Equal,
+			NotEqual,
+			Less,
+			LessEqual,
+			Greater,
+			GreaterEqual,
+		};
+
+		struct Node {
+			NodeType type;
+			std::vector<Node> children;
+			std::string value;
+			bool requireExactMatch{ false };
+			Comparison comparison{ Comparison::Equal };
+			float number{ 0.0f };
+
+			Node() = default;
+			Node(const NodeType type, std::vector<Node> children = {}, std::string value = {}, const bool requireExactMatch = false) :
+				type{ type },
+				children{ std::move(children) },
+				value{ std::move(value) },
+				requireExactMatch{ requireExactMatch }
+			{}
+
+			CONSTEXPR bool IsLeaf() const noexcept { return type != NodeType::And && type != NodeType::Or && type != NodeType::Not; }
+		};
+
+		Node root;
+
+		/**
+		 * @brief					Parses the given query string.
+		 * @param text				The query string to parse.
+		 * @param requireExactMatch	When true, all 'field:value' terms behave like 'field=value' terms.
+		 * @returns					The parsed Query.
+		 * @throws					An exception describing the error & its position when the query is malformed.
+		 */
+		static Query Parse(const std::string& text, const bool requireExactMatch = false)
+		{
+			Parser parser{ text, requireExactMatch };
+			Query query{ parser.parse_or() };
+			if (parser.peek().type != TokenType::End)
+				parser.throwUnexpected();
+			return query;
+		}
+
+	private:
+		enum class TokenType : std::uint8_t {
+			End,
+			Word,
+			String,
+			Operator,
+			LeftBracket,
+			RightBracket,
+		};
+		struct Token {
+			TokenType type;
+			std::string text;
+			size_t pos;
+		};
+
+		struct Parser {
+			const std::string& text;
+			const bool requireExactMatch;
+			size_t pos{ 0 };
+			std::optional<Token> next;
+
+			Parser(const std::string& text, const bool requireExactMatch) : text{ text }, requireExactMatch{ requireExactMatch } {}
+
+			static CONSTEXPR bool is_operator_char(const char c) noexcept { return c == ':' || c == '=' || c == '<' || c == '>' || c == '!'; }
+
+			Token lex()
+			{
+				while (pos < text.size() && std::isspace($c(unsigned char, text[pos]))) ++pos;
+				if (pos == text.size()) return{ TokenType::End, {}, pos };
+
+				const auto start{ pos };
+				const char c{ text[pos] };
+				if (c == '(') return{ TokenType::LeftBracket, std::string(1, text[pos++]), start };
+				if (c == ')') return{ TokenType::RightBracket, std::string(1, text[pos++]), start };
+				if (c == '"') {
+					std::string value;
+					for (++pos; pos < text.size() && text[pos] != '"'; ++pos) {
+						if (text[pos] == '\\' && pos + 1 < text.size()) ++pos;
+						value += text[pos];
+					}
+					if (pos == text.size()) throw make_exception("Unterminated string starting at position ", start, " in query!");
+					++pos; //< skip the closing quote
+					return{ TokenType::String, value, start };
+				}
+				if (is_operator_char(c)) {
+					++pos;
+					if (pos < text.size() && text[pos] == '=' && c != ':' && c != '=') ++pos;
+					const auto op{ text.substr(start, pos - start) };
+					if (op == "!") throw make_exception("Unexpected '!' at position ", start, " in query; use 'NOT' to negate a term.");
+					return{ TokenType::Operator, op, start };
+				}
+				while (pos < text.size() && !std::isspace($c(unsigned char, text[pos])) && text[pos] != '(' && text[pos] != ')' && text[pos] != '"' && !is_operator_char(text[pos]))
+					++pos;
+				return{ TokenType::Word, text.substr(start, pos - start), start };
+			}
+			const Token& peek()
+			{
+				if (!next.has_value()) next = lex();
+				return next.value();
+			}
+			Token take()
+			{
+				auto tkn{ peek() };
+				next.reset();
+				return tkn;
+			}
+			bool take_keyword(const std::string_view keyword)
+			{
+				if (const auto& tkn{ peek() }; tkn.type == TokenType::Word && str::toupper(tkn.text) == keyword) {
+					take();
+					return true;
+				}
+				return false;
+			}
+			[[noreturn]] void throwUnexpected()
+			{
+				const auto& tkn{ peek() };
+				if (tkn.type == TokenType::End)
+					throw make_exception("Unexpected end of query!");
+				throw make_exception("Unexpected '", tkn.text, "' at position ", tkn.pos, " in query!");
+			}
+
+			/// @brief	Checks if the next token can begin a term.
+			bool at_term()
+			{
+				const auto& tkn{ peek() };
+				if (tkn.type == TokenType::Word) {
+					const auto upper{ str::toupper(tkn.text) };
+					return upper != "AND" && upper != "OR";
+				}
+				return tkn.type == TokenType::String || tkn.type == TokenType::LeftBracket;
+			}
+
+			Node parse_or()
+			{
+				Node node{ parse_and() };
+				while (take_keyword("OR")) {
+					if (node.type != NodeType::Or)
+						node = Node{ NodeType::Or, { std::move(node) } };
+					node.children.emplace_back(parse_and());
+				}
+				return node;
+			}
+			Node parse_and()
+			{
+				Node node{ parse_not() };
+				while (take_keyword("AND") || at_term()) {
+					if (node.type != NodeType::And)
+						node = Node{ NodeType::And, { std::move(node) } };
+					node.children.emplace_back(parse_not());
+				}
+				return node;
+			}
+			Node parse_not()
+			{
+				if (take_keyword("NOT"))
+					return Node{ NodeType::Not, { parse_not() } };
+				return parse_primary();
+			}
+			Node parse_primary()
+			{
+				if (peek().type == TokenType::LeftBracket) {
+					take();
+					Node node{ parse_or() };
+					if (peek().type != TokenType::RightBracket)
+						throwUnexpected();
+					take();
+					return node;
+				}
+				if (!at_term()) throwUnexpected();
+
+				auto tkn{ take() };
+				const auto field{ str::tolower(tkn.text) };
+				const bool isStat{ tkn.type == TokenType::Word && (field == "mag" || field == "magnitude" || field == "dur" || field == "duration") };
+
+				// parse the effect scope of a 'stat(effect)<OP>number' term
+				std::string scope;
+				if (isStat && peek().type == TokenType::LeftBracket) {
+					take();
+					while (peek().type == TokenType::Word || peek().type == TokenType::String) {
+						if (!scope.empty()) scope += ' ';
+						scope += take().text;
+					}
+					if (peek().type != TokenType::RightBracket || scope.empty())
+						throwUnexpected();
+					take();
+					if (peek().type != TokenType::Operator)
+						throwUnexpected();
+				}
+
+				if (tkn.type == TokenType::String || peek().type != TokenType::Operator)
+					return Node{ NodeType::Any, {}, tkn.text, requireExactMatch };
+
+				// this is a 'field:value' or 'stat<OP>number' term
+				const auto op{ take() };
+
+				if (field == "mag" || field == "magnitude" || field == "dur" || field == "duration") {
+					Node node{ (field.front() == 'm') ? NodeType::Magnitude : NodeType::Duration };
+					node.requireExactMatch = requireExactMatch;
+					node.comparison = parse_comparison(op);
+					const auto numberTkn{ take() };
+					const auto& numberStr{ numberTkn.text };
+					if (numberTkn.type != TokenType::Word || std::from_chars(numberStr.data(), numberStr.data() + numberStr.size(), node.number).ptr != numberStr.data() + numberStr.size())
+						throw make_exception("Expected a number at position ", numberTkn.pos, " in query, but found '", numberStr, "'!");
+					node.value = scope;
+					return node;
+				}
+
+				NodeType type;
+				if (field == "name" || field == "ingr" || field == "ingredient")
+					type = NodeType::Name;
+				else if (field == "effect" || field == "fx")
+					type = NodeType::Effect;
+				else if (field == "keyword" || field == "kywd")
+					type = NodeType::Keyword;
+				else throw make_exception("Unknown field '", tkn.text, "' at position ", tkn.pos, " in query!");
+
+				if (op.text != ":" && op.text != "=")
+					throw make_exception("Unexpected '", op.text, "' at position ", op.pos, " in query; expected ':' or '='.");
+
+				const auto valueTkn{ take() };
+				if (valueTkn.type != TokenType::Word && valueTkn.type != TokenType::String)
+					throw make_exception("Expected a value at position ", valueTkn.pos, " in query, but found '", valueTkn.text, "'!");
+				return Node{ type, {}, valueTkn.text, requireExactMatch || op.text == "=" };
+			}
+			static Comparison parse_comparison(const Token& op)
+			{
+				if (op.text == "=") return Comparison::Equal;
+				if (op.text == "!=") return Comparison::NotEqual;
+				if (op.text == "<") return Comparison::Less;
+				if (op.text == "<=") return Comparison::LessEqual;
+				if (op.text == ">") return Comparison::Greater;
+				if (op.text == ">=") return Comparison::GreaterEqual;
+				throw make_exception("Unexpected '", op.text, "' at position ", op.pos, " in query; expected a comparison operator.");
+			}
+		};
+	};
+
+	/**
+	 * @brief		A Query that has been resolved against a RegistryIndex.
+	 *				Effect & keyword terms are resolved to EffectIDs when the plan is compiled, so executing
+	 *				 the plan only merges their posting lists; everything else is combined as bitsets.
+	 */
+	class QueryPlan {
+		struct Step {
+			Query::NodeType type;
+			std::vector<Step> children;
+			const Query::Node* node;
+			/// @brief	The effects matched by Effect, Keyword & Any terms.
+			std::vector<EffectID> effectIDs;
+			size_t postingCount{ 0 };
+
+			Step() = default;
+			Step(const Query::NodeType type, const Query::Node* node) : type{ type }, node{ node } {}
+		};
+
+		const RegistryIndex* index;
+		Step root;
+
+		Step compile(const Query::Node& node) const
+		{
+			Step step{ node.type, &node };
+			switch (node.type) {
+			case Query::NodeType::And:
+			case Query::NodeType::Or:
+			case Query::NodeType::Not:
+				step.children.reserve(node.children.size());
+				for (const auto& child : node.children)
+					step.children.emplace_back(compile(child));
+				break;
+			case Query::NodeType::Any:
+			case Query::NodeType::Effect:
+				step.effectIDs = index->FindEffects(node.value, node.requireExactMatch);
+				break;
+			case Query::NodeType::Keyword:
+				step.effectIDs = index->FindEffectsWithKeyword(node.value, node.requireExactMatch);
+				break;
+			case Query::NodeType::Magnitude:
+			case Query::NodeType::Duration:
+				if (node.value.empty()) { // unscoped; consider every effect
+					step.effectIDs.resize(index->GetEffectCount());
+					std::iota(step.effectIDs.begin(), step.effectIDs.end(), EffectID{ 0 });
+				}
+				else step.effectIDs = index->FindEffects(node.value, node.requireExactMatch);
+				break;
+			default:
+				break;
+			}
+			for (const auto& effectID : step.effectIDs)
+				step.postingCount += index->GetPostings(effectID).size();
+			return step;
+		}
+
+		/// @brief	Converts a comparison to the equivalent inclusive range(s). Only NotEqual uses the second range.
+		static std::pair<StatRange, std::optional<StatRange>> to_ranges(const Query::Comparison comparison, const float number) noexcept
+		{
+			constexpr auto inf{ std::numeric_limits<float>::infinity() };
+			switch (comparison) {
+			case Query::Comparison::Equal:
+				return{ StatRange{ number, number }, std::nullopt };
+			case Query::Comparison::NotEqual:
+				return{ StatRange{ -inf, std::nextafter(number, -inf) }, StatRange{ std::nextafter(number, inf), inf } };
+			case Query::Comparison::Less:
+				return{ StatRange{ -inf, std::nextafter(number, -inf) }, std::nullopt };
+			case Query::Comparison::LessEqual:
+				return{ StatRange{ -inf, number }, std::nullopt };
+			case Query::Comparison::Greater:
+				return{ StatRange{ std::nextafter(number, inf), inf }, std::nullopt };
+			case Query::Comparison::GreaterEqual:
+				return{ StatRange{ number, inf }, std::nullopt };
+			}
+			return{};
+		}
+
+		ResultSet execute(const Step& step) const
+		{
+			const auto& registry{ index->GetRegistry() };
+			switch (step.type) {
+			case Query::NodeType::And: {
+				auto results{ execute(step.children.front()) };
+				for (auto it{ step.children.begin() + 1 }; it != step.children.end() && !results.empty(); ++it)
+					results &= execute(*it);
+				return results;
+			}
+			case Query::NodeType::Or: {
+				auto results{ execute(step.children.front()) };
+				for (auto it{ step.children.begin() + 1 }; it != step.children.end(); ++it)
+					results |= execute(*it);
+				return results;
+			}
+			case Query::NodeType::Not:
+				return ~execute(step.children.front());
+			case Query::NodeType::Effect:
+			case Query::NodeType::Keyword:
+				return index->GetIngredientsWithAnyEffect(step.effectIDs);
+			case Query::NodeType::Name:
+				return index->FindIngredients(step.node->value, step.node->requireExactMatch);
+			case Query::NodeType::Any: {
+				auto results{ index->GetIngredientsWithAnyEffect(step.effectIDs) };
+				results |= index->FindIngredients(step.node->value, step.node->requireExactMatch);
+				return results;
+			}
+			case Query::NodeType::Magnitude:
+			case Query::NodeType::Duration: {
+				const auto& select{ [this, &step](const StatRange& range) {
+					return (step.type == Query::NodeType::Magnitude)
+						? index->SelectInRange(step.effectIDs, range)
+						: index->SelectInRange(step.effectIDs, {}, range);
+				} };
+				const auto& [range, secondRange] { to_ranges(step.node->comparison, step.node->number) };
+				auto results{ select(range) };
+				if (secondRange.has_value())
+					results |= select(secondRange.value());
+				return results;
+			}
+			}
+			return{ registry.Ingredients };
+		}
+
+		static std::string_view comparison_to_string(const Query::Comparison comparison)
+		{
+			switch (comparison) {
+			case Query::Comparison::Equal:
+				return "=";
+			case Query::Comparison::NotEqual:
+				return "!=";
+			case Query::Comparison::Less:
+				return "<";
+			case Query::Comparison::LessEqual:
+				return "<=";
+			case Query::Comparison::Greater:
+				return ">";
+			case Query::Comparison::GreaterEqual:
+				return ">=";
+			}
+			return "?";
+		}
+
+		std::ostream& print(std::ostream& os, const Step& step, const size_t depth) const
+		{
+			os << std::string(depth * 2, ' ');
+			const auto& node{ *step.node };
+			const auto matchOp{ node.requireExactMatch ? " = \"" : " ~ \"" };
+			switch (step.type) {
+			case Query::NodeType::And:
+				os << "AND";
+				break;
+			case Query::NodeType::Or:
+				os << "OR";
+				break;
+			case Query::NodeType::Not:
+				os << "NOT (complement)";
+				break;
+			case Query::NodeType::Any:
+				os << "name|effect" << matchOp << node.value << "\"  [scan names; " << step.effectIDs.size() << " effect(s), " << step.postingCount << " posting(s)]";
+				break;
+			case Query::NodeType::Name:
+				os << "name" << matchOp << node.value << "\"  [scan names]";
+				break;
+			case Query::NodeType::Effect:
+				os << "effect" << matchOp << node.value << "\"  [" << step.effectIDs.size() << " effect(s), " << step.postingCount << " posting(s)]";
+				break;
+			case Query::NodeType::Keyword:
+				os << "keyword" << matchOp << node.value << "\"  [" << step.effectIDs.size() << " effect(s), " << step.postingCount << " posting(s)]";
+				break;
+			case Query::NodeType::Magnitude:
+			case Query::NodeType::Duration:
+				os << ((step.type == Query::NodeType::Magnitude) ? "magnitude" : "duration");
+				if (!node.value.empty())
+					os << "(effect" << matchOp << node.value << "\")";
+				os << ' ' << comparison_to_string(node.comparison) << ' ' << node.number << "  [binary search " << step.effectIDs.size() << " sorted column(s)]";
+				break;
+			}
+			for (const auto& child : step.children)
+				print(os << '\n', child, depth + 1);
+			return os;
+		}
+
+	public:
+		/**
+		 * @brief		Compiles the given query against the given index.
+		 * @param query	The query to compile. This must outlive the plan.
+		 * @param index	The index to execute the query against. This must outlive the plan.
+		 */
+		QueryPlan(const Query& query, const RegistryIndex& index) : index{ &index }, root{ compile(query.root) } {}
+
+		/// @brief	Executes the plan & returns the matching ingredients.
+		ResultSet Execute() const
+		{
+			return execute(root);
+		}
+
+		/// @brief	Gets the names of all effects matched by terms that aren't negated, for highlighting results.
+		std::vector<std::string> GetMatchedEffectNames() const
+		{
+			std::vector<std::string> names;
+			const auto& collect{ [this, &names](auto&& self, const Step& step) -> void {
+				if (step.type == Query::NodeType::Not) return;
+				for (const auto& effectID : step.effectIDs)
+					names.emplace_back(index->GetEffectName(effectID));
+				for (const auto& child : step.children)
+					self(self, child);
+			} };
+			collect(collect, root);
+			return names;
+		}
+
+		/// @brief	Prints the plan as an indented tree.
+		friend std::ostream& operator<<(std::ostream& os, const QueryPlan& plan)
+		{
+			return plan.print(os, plan.root, 0);
+		}
+	};
+}
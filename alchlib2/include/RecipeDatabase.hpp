@@ -0,0 +1,602 @@
+#pragma once
+#include "BoundedHeap.hpp"
+#include "MappedFile.hpp"
+#include "PotionCache.hpp"
+#include "RecipeSolver.hpp"
+#include "SignatureIndex.hpp"
+
+#include <make_exception.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+
+namespace alchlib2 {
+	/// @brief	An evaluated recipe, as it's stored in a recipe database file.
+	struct RecipeRecord {
+		std::array<IngredientID, MAX_POTION_INGREDIENTS> ingredients;
+		/// @brief	The potion's effects, in the same order as PotionHandle::GetEffectIDs().
+		std::array<EffectID, MAX_COMMON_EFFECTS> effectIDs;
+		std::array<float, MAX_COMMON_EFFECTS> magnitudes;
+		std::array<std::uint32_t, MAX_COMMON_EFFECTS> durations;
+		/// @brief	The value of the potion in gold.
+		std::uint32_t value;
+		/// @brief	The EPotionClass of the potion.
+		std::uint8_t classes;
+		std::uint8_t ingredientCount;
+		std::uint8_t effectCount;
+		std::uint8_t padding;
+
+		CONSTEXPR std::span<const IngredientID> GetIngredients() const noexcept { return{ ingredients.data(), ingredientCount }; }
+		CONSTEXPR std::span<const EffectID> GetEffectIDs() const noexcept { return{ effectIDs.data(), effectCount }; }
+		CONSTEXPR std::span<const float> GetMagnitudes() const noexcept { return{ magnitudes.data(), effectCount }; }
+		CONSTEXPR std::span<const std::uint32_t> GetDurations() const noexcept { return{ durations.data(), effectCount }; }
+		/// @brief	Gets the position of an effect in the record, or effectCount if the potion doesn't have it.
+		CONSTEXPR size_t FindEffect(const EffectID id) const noexcept { return $c(size_t, std::find(effectIDs.begin(), effectIDs.begin() + effectCount, id) - effectIDs.begin()); }
+	};
+
+	/// @brief	A set of effects in a recipe database file, & the range of recipes that have exactly those effects.
+	struct SignatureRecord {
+		/// @brief	In ascending order.
+		std::array<EffectID, MAX_COMMON_EFFECTS> effectIDs;
+		std::uint32_t effectCount;
+		/// @brief	The position of the first recipe with this signature.
+		std::uint32_t first;
+		std::uint32_t count;
+
+		CONSTEXPR std::span<const EffectID> GetEffectIDs() const noexcept { return{ effectIDs.data(), effectCount }; }
+	};
+
+	/**
+	 * @brief		The header at the start of a recipe database file.
+	 *				Each section is an array that starts at its offset from the start of the file, which is a multiple of 8.
+	 */
+	struct RecipeDatabaseHeader {
+		std::array<char, 8> magic;
+		std::uint32_t version;
+		/// @brief	Always 0x01020304 when written & read on machines with the same byte order.
+		std::uint32_t byteOrder;
+		std::uint64_t fileSize;
+		/// @brief	The fingerprint of the registry, from get_registry_fingerprint.
+		std::uint64_t registryFingerprint;
+		/// @brief	The fingerprint of the game settings & perks, from PotionCalculator::GetFingerprint.
+		std::uint64_t calculatorFingerprint;
+		std::uint32_t maxIngredients;
+		/// @brief	The number of effects in the registry, which is the number of per-effect lists.
+		std::uint32_t effectCount;
+		std::uint64_t recipeCount;
+		std::uint64_t signatureCount;
+		/// @brief	The number of ingredients in the registry.
+		std::uint64_t ingredientCount;
+		/// @brief	RecipeRecord[recipeCount], grouped by signature.
+		std::uint64_t recipesOffset;
+		/// @brief	SignatureRecord[signatureCount], sorted by their effects.
+		std::uint64_t signaturesOffset;
+		/// @brief	std::uint32_t[effectCount + 1]; the recipes with effect e are listed in [effectOffsets[e], effectOffsets[e + 1]).
+		std::uint64_t effectOffsetsOffset;
+		/// @brief	std::uint32_t positions of recipes, grouped by effect, each group ordered by that effect's magnitude.
+		std::uint64_t effectRecipesOffset;
+		/// @brief	std::uint64_t[ingredientCount]; the content hash of each ingredient, from get_ingredient_hash.
+		std::uint64_t ingredientHashesOffset;
+		/// @brief	std::uint64_t[effectCount]; the content hash of each effect, from get_effect_fingerprint.
+		std::uint64_t effectHashesOffset;
+	};
+
+	static_assert(std::is_trivially_copyable_v<RecipeRecord> && std::is_standard_layout_v<RecipeRecord>);
+	static_assert(std::is_trivially_copyable_v<SignatureRecord> && std::is_standard_layout_v<SignatureRecord>);
+	static_assert(std::is_trivially_copyable_v<RecipeDatabaseHeader> && std::is_standard_layout_v<RecipeDatabaseHeader>);
+
+	/// @brief	Hashes an ingredient & its effects, so it can be found in a modified registry. Ingredients with the same hash
+	///			 always make the same potions as each other.
+	inline std::uint64_t get_ingredient_hash(RegistryIndex const& index, const IngredientID id)
+	{
+		Fingerprint fingerprint;
+		fingerprint.add(std::string_view{ index.GetIngredient(id).name });
+		const auto& effectIDs{ index.GetEffectIDs(id) };
+		const auto& magnitudes{ index.GetMagnitudes(id) };
+		const auto& durations{ index.GetDurations(id) };
+		for (size_t e{ 0 }; e < effectIDs.size(); ++e)
+			fingerprint.add(get_effect_fingerprint(index, effectIDs[e])).add(magnitudes[e]).add(durations[e]);
+		return fingerprint;
+	}
+
+	/// @brief	What RecipeDatabase::Update did.
+	struct RecipeDatabaseUpdate {
+		/// @brief	The number of recipes that were written.
+		size_t recipeCount;
+		/// @brief	The number of recipes that were carried over from the previous database without being evaluated.
+		size_t reusedCount;
+		/// @brief	The number of ingredients that were added or modified since the previous database.
+		size_t changedCount;
+	};
+
+	/// @brief	A recipe from a recipe database, with its score for a query.
+	struct DatabaseResult {
+		const RecipeRecord* record;
+		float score;
+	};
+
+	/**
+	 * @brief		A precomputed file of every useful recipe for a registry, game settings & perks, with indexes by effect signature &
+	 *				 by effect, that is memory-mapped instead of read so that queries only touch the pages they need.
+	 *				Records are stored in the native byte order, so files can't be shared between machines with different byte orders.
+	 *				Each file keeps a content hash of every ingredient, so that Update only has to evaluate the recipes of ingredients
+	 *				 that were added or modified since it was built.
+	 *				Pointers & spans into the database are only valid while it exists.
+	 */
+	class RecipeDatabase {
+		static constexpr std::array<char, 8> MAGIC{ 'A', 'L', 'C', 'H', 'R', 'D', 'B', '\0' };
+		static constexpr std::uint32_t VERSION{ 3 };
+		static constexpr std::uint32_t ENDIAN_CHECK{ 0x01020304 };
+
+		MappedFile file;
+		const RecipeDatabaseHeader* header;
+		std::span<const RecipeRecord> recipes;
+		std::span<const SignatureRecord> signatures;
+		std::span<const std::uint32_t> effectOffsets;
+		std::span<const std::uint32_t> effectRecipes;
+		std::span<const std::uint64_t> ingredientHashes;
+		std::span<const std::uint64_t> effectHashes;
+
+		/// @brief	Gets a section of the file, checking that it's within the file & aligned.
+		template<typename T>
+		std::span<const T> get_section(std::filesystem::path const& path, const std::uint64_t offset, const std::uint64_t count) const
+		{
+			const auto& bytes{ file.GetBytes() };
+			if (offset % alignof(T) != 0 || offset > bytes.size() || count > (bytes.size() - offset) / sizeof(T))
+				throw make_exception("Recipe database file ", path, " is corrupted!");
+			return{ reinterpret_cast<const T*>(bytes.data() + offset), $c(size_t, count) };
+		}
+
+		/// @brief	Writes an array to a file, followed by zeroes up to the next multiple of 8 bytes.
+		template<typename T>
+		static void write_section(std::ofstream& out, std::span<const T> values)
+		{
+			static constexpr char zeroes[8]{};
+			const auto size{ values.size_bytes() };
+			out.write(reinterpret_cast<const char*>(values.data()), $c(std::streamsize, size));
+			out.write(zeroes, $c(std::streamsize, (8 - size % 8) % 8));
+		}
+		/// @brief	Maps a float to an integer with the same order, treating -0 & +0 as equal.
+		static CONSTEXPR std::uint32_t get_ordered_bits(const float f) noexcept
+		{
+			const auto bits{ std::bit_cast<std::uint32_t>(f + 0.0f) };
+			return (bits & 0x80000000u) != 0 ? ~bits : bits | 0x80000000u;
+		}
+		/// @brief	Gets the size of an array in a file, including the zeroes that write_section pads it with.
+		static CONSTEXPR std::uint64_t get_section_size(const size_t size) noexcept { return (size + 7) / 8 * 8; }
+
+		/// @brief	Orders recipes by score, then by their position in the database.
+		struct ResultOrder {
+			bool operator()(DatabaseResult const& l, DatabaseResult const& r) const noexcept
+			{
+				if (l.score != r.score)
+					return l.score > r.score;
+				return l.record < r.record;
+			}
+		};
+
+		/// @brief	Reads the header of a file, or returns std::nullopt if it doesn't exist or can't be opened by this version.
+		static std::optional<RecipeDatabaseHeader> read_header(std::filesystem::path const& path)
+		{
+			std::ifstream in{ path, std::ios::binary };
+			RecipeDatabaseHeader header;
+			if (!in || !in.read(reinterpret_cast<char*>(&header), sizeof(header)))
+				return std::nullopt;
+			if (header.magic != MAGIC || header.version != VERSION || header.byteOrder != ENDIAN_CHECK || header.fileSize != std::filesystem::file_size(path))
+				return std::nullopt;
+			return header;
+		}
+
+		/// @brief	Copies every valid potion in a batch into records.
+		static void add_records(PotionBatch const& batch, std::vector<unsigned>& values, std::vector<RecipeRecord>& records)
+		{
+			get_potion_values(batch, values);
+			for (size_t i{ 0 }; i < batch.size(); ++i) {
+				if (!batch.IsValid(i)) continue;
+				RecipeRecord record{};
+				const auto& ingredients{ batch.GetRecipe(i).GetIngredients() };
+				std::ranges::copy(ingredients, record.ingredients.begin());
+				std::ranges::copy(batch.GetEffectIDs(i), record.effectIDs.begin());
+				std::ranges::copy(batch.GetMagnitudes(i), record.magnitudes.begin());
+				std::ranges::copy(batch.GetDurations(i), record.durations.begin());
+				record.value = values[i];
+				record.classes = $c(std::uint8_t, batch.GetClass(i));
+				record.ingredientCount = $c(std::uint8_t, ingredients.size());
+				record.effectCount = $c(std::uint8_t, batch.GetEffectCount(i));
+				records.emplace_back(record);
+			}
+		}
+
+		/**
+		 * @brief					Indexes records by signature & by effect, then writes them to a database file.
+		 * @param path				The path of the file.
+		 * @param index				The index of the registry.
+		 * @param calculator		The compiled game settings & perks that the records were evaluated with.
+		 * @param maxIngredients	The maximum number of ingredients per recipe that the records were enumerated with.
+		 * @param evaluated			Every useful recipe, in any order. Their ingredients must be in ascending order.
+		 */
+		static void write(std::filesystem::path const& path, RegistryIndex const& index, PotionCalculator const& calculator, const size_t maxIngredients, std::vector<RecipeRecord> const& evaluated)
+		{
+			// find the signature of each recipe
+			std::vector<std::uint32_t> positions;
+			std::vector<EffectSignature> found;
+			std::unordered_map<EffectSignature, std::uint32_t, EffectSignature::Hash> lookup;
+			positions.reserve(evaluated.size());
+			for (const auto& record : evaluated) {
+				const EffectSignature signature{ record.GetEffectIDs() };
+				// records that were carried over by Update are still grouped by signature, so most lookups can be skipped
+				if (!positions.empty() && found[positions.back()] == signature) {
+					positions.emplace_back(positions.back());
+					continue;
+				}
+				const auto& [it, added] { lookup.emplace(signature, $c(std::uint32_t, found.size())) };
+				if (added)
+					found.emplace_back(signature);
+				positions.emplace_back(it->second);
+			}
+
+			// sort the signatures so they can be binary searched, then group the recipes by signature with a counting sort
+			std::vector<std::uint32_t> order(found.size());
+			std::iota(order.begin(), order.end(), 0u);
+			std::ranges::sort(order, [&found](auto&& l, auto&& r) { return std::ranges::lexicographical_compare(found[l].GetEffectIDs(), found[r].GetEffectIDs()); });
+			std::vector<std::uint32_t> rank(found.size());
+			for (std::uint32_t s{ 0 }; s < order.size(); ++s)
+				rank[order[s]] = s;
+
+			std::vector<SignatureRecord> signatures(found.size());
+			for (const auto& position : positions)
+				++signatures[rank[position]].count;
+			for (std::uint32_t s{ 0 }, first{ 0 }; s < signatures.size(); ++s) {
+				const auto& effectIDs{ found[order[s]].GetEffectIDs() };
+				std::ranges::copy(effectIDs, signatures[s].effectIDs.begin());
+				signatures[s].effectCount = $c(std::uint32_t, effectIDs.size());
+				signatures[s].first = first;
+				first += signatures[s].count;
+			}
+			std::vector<RecipeRecord> recipes(evaluated.size());
+			{
+				std::vector<std::uint32_t> next(signatures.size());
+				for (size_t s{ 0 }; s < signatures.size(); ++s)
+					next[s] = signatures[s].first;
+				for (size_t r{ 0 }; r < evaluated.size(); ++r)
+					recipes[next[rank[positions[r]]]++] = evaluated[r];
+			}
+			// the recipes of each signature are kept in lexicographic order, whatever order they were evaluated in
+			const auto& lexicographic{ [](auto&& l, auto&& r) { return std::ranges::lexicographical_compare(l.GetIngredients(), r.GetIngredients()); } };
+			for (const auto& signature : signatures) {
+				const auto& group{ std::span{ recipes }.subspan(signature.first, signature.count) };
+				if (!std::ranges::is_sorted(group, lexicographic))
+					std::ranges::sort(group, lexicographic);
+			}
+
+			// list the recipes with each effect, from the strongest magnitude to the weakest
+			const auto effectCount{ index.GetEffectCount() };
+			std::vector<std::uint32_t> effectOffsets(effectCount + 1, 0u);
+			for (const auto& record : recipes)
+				for (const auto& id : record.GetEffectIDs())
+					++effectOffsets[id + 1];
+			for (size_t e{ 0 }; e < effectCount; ++e)
+				effectOffsets[e + 1] += effectOffsets[e];
+			// each entry is sorted as one integer, with the magnitude inverted in the high bits & the position in the low bits,
+			//  so ties stay in the order of the recipes & comparisons don't have to find the effect in the recipe
+			std::vector<std::uint64_t> keys(effectOffsets.back());
+			{
+				auto next{ effectOffsets };
+				for (std::uint32_t r{ 0 }; r < recipes.size(); ++r)
+					for (size_t e{ 0 }; e < recipes[r].effectCount; ++e)
+						keys[next[recipes[r].effectIDs[e]]++] = std::uint64_t{ ~get_ordered_bits(recipes[r].magnitudes[e]) } << 32 | r;
+			}
+			for (EffectID e{ 0 }; e < effectCount; ++e)
+				std::sort(keys.begin() + effectOffsets[e], keys.begin() + effectOffsets[e + 1]);
+			std::vector<std::uint32_t> effectRecipes(keys.size());
+			std::ranges::transform(keys, effectRecipes.begin(), [](auto&& key) { return $c(std::uint32_t, key); });
+
+			std::vector<std::uint64_t> ingredientHashes(index.GetRegistry().size());
+			for (IngredientID id{ 0 }; id < ingredientHashes.size(); ++id)
+				ingredientHashes[id] = get_ingredient_hash(index, id);
+			std::vector<std::uint64_t> effectHashes(effectCount);
+			for (EffectID id{ 0 }; id < effectCount; ++id)
+				effectHashes[id] = get_effect_fingerprint(index, id);
+
+			RecipeDatabaseHeader header{};
+			header.magic = MAGIC;
+			header.version = VERSION;
+			header.byteOrder = ENDIAN_CHECK;
+			header.registryFingerprint = get_registry_fingerprint(index);
+			header.calculatorFingerprint = calculator.GetFingerprint();
+			header.maxIngredients = $c(std::uint32_t, maxIngredients);
+			header.effectCount = $c(std::uint32_t, effectCount);
+			header.recipeCount = recipes.size();
+			header.signatureCount = signatures.size();
+			header.ingredientCount = ingredientHashes.size();
+			header.recipesOffset = get_section_size(sizeof(RecipeDatabaseHeader));
+			header.signaturesOffset = header.recipesOffset + get_section_size(recipes.size() * sizeof(RecipeRecord));
+			header.effectOffsetsOffset = header.signaturesOffset + get_section_size(signatures.size() * sizeof(SignatureRecord));
+			header.effectRecipesOffset = header.effectOffsetsOffset + get_section_size(effectOffsets.size() * sizeof(std::uint32_t));
+			header.ingredientHashesOffset = header.effectRecipesOffset + get_section_size(effectRecipes.size() * sizeof(std::uint32_t));
+			header.effectHashesOffset = header.ingredientHashesOffset + get_section_size(ingredientHashes.size() * sizeof(std::uint64_t));
+			header.fileSize = header.effectHashesOffset + get_section_size(effectHashes.size() * sizeof(std::uint64_t));
+
+			std::ofstream out{ path, std::ios::binary | std::ios::trunc };
+			if (!out)
+				throw make_exception("Failed to open ", path, " for writing!");
+			write_section(out, std::span<const RecipeDatabaseHeader>{ &header, 1 });
+			write_section<RecipeRecord>(out, recipes);
+			write_section<SignatureRecord>(out, signatures);
+			write_section<std::uint32_t>(out, effectOffsets);
+			write_section<std::uint32_t>(out, effectRecipes);
+			write_section<std::uint64_t>(out, ingredientHashes);
+			write_section<std::uint64_t>(out, effectHashes);
+			if (!out)
+				throw make_exception("Failed to write the recipe database to ", path, "!");
+		}
+
+	public:
+		/**
+		 * @brief		Opens a database that was written by Build.
+		 * @param path	The path of the file.
+		 */
+		RecipeDatabase(std::filesystem::path const& path) : file{ path }
+		{
+			const auto& bytes{ file.GetBytes() };
+			if (bytes.size() < sizeof(RecipeDatabaseHeader))
+				throw make_exception("Recipe database file ", path, " is invalid!");
+			header = reinterpret_cast<const RecipeDatabaseHeader*>(bytes.data());
+			if (header->magic != MAGIC)
+				throw make_exception("Recipe database file ", path, " is invalid!");
+			if (header->version != VERSION)
+				throw make_exception("Recipe database file ", path, " has version ", header->version, ", but only version ", VERSION, " is supported! (Rebuild it)");
+			if (header->byteOrder != ENDIAN_CHECK)
+				throw make_exception("Recipe database file ", path, " was built on a machine with a different byte order! (Rebuild it)");
+			if (header->fileSize != bytes.size())
+				throw make_exception("Recipe database file ", path, " is truncated!");
+
+			recipes = get_section<RecipeRecord>(path, header->recipesOffset, header->recipeCount);
+			signatures = get_section<SignatureRecord>(path, header->signaturesOffset, header->signatureCount);
+			effectOffsets = get_section<std::uint32_t>(path, header->effectOffsetsOffset, std::uint64_t{ header->effectCount } + 1);
+			effectRecipes = get_section<std::uint32_t>(path, header->effectRecipesOffset, effectOffsets.back());
+			ingredientHashes = get_section<std::uint64_t>(path, header->ingredientHashesOffset, header->ingredientCount);
+			effectHashes = get_section<std::uint64_t>(path, header->effectHashesOffset, header->effectCount);
+			for (const auto& signature : signatures)
+				if (signature.effectCount > MAX_COMMON_EFFECTS || signature.first > recipes.size() || signature.count > recipes.size() - signature.first)
+					throw make_exception("Recipe database file ", path, " is corrupted!");
+			if (!std::ranges::is_sorted(effectOffsets) || std::ranges::any_of(effectRecipes, [this](auto&& r) { return r >= recipes.size(); }))
+				throw make_exception("Recipe database file ", path, " is corrupted!");
+		}
+
+		/**
+		 * @brief					Evaluates every useful recipe on a thread pool & writes them to a database file.
+		 * @param path				The path of the file.
+		 * @param matrix			The compatibility matrix of the registry.
+		 * @param builder			The builder to evaluate recipes with.
+		 * @param calculator		The compiled game settings & perks to apply.
+		 * @param maxIngredients	The maximum number of ingredients per recipe, from 2 to MAX_POTION_INGREDIENTS.
+		 * @param threadCount		The number of threads to evaluate recipes with. 0 uses one thread per hardware thread.
+		 * @returns					The number of recipes that were written.
+		 */
+		static size_t Build(std::filesystem::path const& path, CompatibilityMatrix const& matrix, PotionBuilder const& builder, PotionCalculator const& calculator, const size_t maxIngredients = 3, const unsigned threadCount = 0)
+		{
+			std::vector<RecipeRecord> evaluated;
+			std::vector<unsigned> values;
+			RecipeEnumerator{ matrix, 2, maxIngredients }.Run(builder, calculator, [&](PotionBatch const& batch) { add_records(batch, values, evaluated); }, threadCount);
+			write(path, matrix.GetIndex(), calculator, maxIngredients, evaluated);
+			return evaluated.size();
+		}
+
+		/**
+		 * @brief					Brings a database file up to date with a modified registry, by only evaluating the recipes that use an
+		 *							 ingredient that was added or modified since the file was written. Ingredients are matched by
+		 *							 get_ingredient_hash, & every other recipe is carried over with its IDs remapped.
+		 *							When the file doesn't exist, is from a different version, or was built with different game settings,
+		 *							 perks or maximum number of ingredients, every recipe is evaluated like Build does.
+		 * @param path				The path of the file, which is replaced.
+		 * @param matrix			The compatibility matrix of the registry.
+		 * @param builder			The builder to evaluate recipes with.
+		 * @param calculator		The compiled game settings & perks to apply.
+		 * @param maxIngredients	The maximum number of ingredients per recipe, from 2 to MAX_POTION_INGREDIENTS.
+		 * @param threadCount		The number of threads to evaluate recipes with. 0 uses one thread per hardware thread.
+		 * @returns					The number of recipes that were written, reused & the number of changed ingredients.
+		 */
+		static RecipeDatabaseUpdate Update(std::filesystem::path const& path, CompatibilityMatrix const& matrix, PotionBuilder const& builder, PotionCalculator const& calculator, const size_t maxIngredients = 3, const unsigned threadCount = 0)
+		{
+			const auto& index{ matrix.GetIndex() };
+			const auto ingredientCount{ index.GetRegistry().size() };
+			if (const auto& header{ read_header(path) }; !header.has_value() || header->calculatorFingerprint != calculator.GetFingerprint() || header->maxIngredients != maxIngredients)
+				return{ Build(path, matrix, builder, calculator, maxIngredients, threadCount), 0, ingredientCount };
+
+			std::vector<RecipeRecord> evaluated;
+			std::vector<IngredientID> changed;
+			// recipes of unchanged ingredients whose order changed, which might list tied effects in a different order
+			std::vector<Recipe> reordered;
+			{
+				const RecipeDatabase previous{ path };
+				if (previous.IsCurrent(index, calculator))
+					return{ previous.size(), previous.size(), 0 };
+
+				// match each previous ingredient with an unchanged one, in order when there are several with the same hash
+				std::unordered_map<std::uint64_t, std::vector<IngredientID>> unmatched;
+				for (auto id{ $c(IngredientID, ingredientCount) }; id-- > 0;)
+					unmatched[get_ingredient_hash(index, id)].emplace_back(id);
+				std::vector<IngredientID> ingredientMap(previous.ingredientHashes.size(), NullIngredientID);
+				for (size_t id{ 0 }; id < ingredientMap.size(); ++id) {
+					if (const auto& it{ unmatched.find(previous.ingredientHashes[id]) }; it != unmatched.end() && !it->second.empty()) {
+						ingredientMap[id] = it->second.back();
+						it->second.pop_back();
+					}
+				}
+				// whatever's left was added or modified
+				for (const auto& [hash, ids] : unmatched)
+					changed.insert(changed.end(), ids.begin(), ids.end());
+				std::ranges::sort(changed);
+
+				std::unordered_map<std::uint64_t, EffectID> effects;
+				for (EffectID id{ 0 }; id < index.GetEffectCount(); ++id)
+					effects.emplace(get_effect_fingerprint(index, id), id);
+				std::vector<EffectID> effectMap(previous.effectHashes.size(), NullEffectID);
+				for (size_t id{ 0 }; id < effectMap.size(); ++id)
+					if (const auto& it{ effects.find(previous.effectHashes[id]) }; it != effects.end())
+						effectMap[id] = it->second;
+
+				// carry over every recipe that only uses unchanged ingredients
+				evaluated.reserve(previous.size());
+				for (auto record : previous.GetRecipes()) {
+					if (record.ingredientCount > MAX_POTION_INGREDIENTS || record.effectCount > MAX_COMMON_EFFECTS)
+						throw make_exception("Recipe database file ", path, " is corrupted!");
+					const std::span ingredients{ record.ingredients.data(), record.ingredientCount };
+					if (std::ranges::any_of(ingredients, [&](auto&& id) { return id >= ingredientMap.size() || ingredientMap[id] == NullIngredientID; }))
+						continue;
+					for (auto& id : ingredients)
+						id = ingredientMap[id];
+					bool remapped{ std::ranges::is_sorted(ingredients) };
+					for (auto& id : std::span{ record.effectIDs.data(), record.effectCount }) {
+						id = id < effectMap.size() ? effectMap[id] : NullEffectID;
+						remapped = remapped && id != NullEffectID;
+					}
+					if (remapped)
+						evaluated.emplace_back(record);
+					else {
+						std::ranges::sort(ingredients);
+						Recipe recipe;
+						for (const auto& id : ingredients)
+							recipe.ingredients[recipe.count++] = id;
+						reordered.emplace_back(recipe);
+					}
+				}
+			}
+			const auto reusedCount{ evaluated.size() };
+
+			// then evaluate the recipes that use a changed ingredient
+			std::vector<unsigned> values;
+			if (!changed.empty()) {
+				RecipeEnumerator enumerator{ matrix, 2, maxIngredients };
+				enumerator.RequireAny(changed);
+				enumerator.Run(builder, calculator, [&](PotionBatch const& batch) { add_records(batch, values, evaluated); }, threadCount);
+			}
+			if (!reordered.empty()) {
+				PotionBatch batch{ index };
+				builder.BuildMany(reordered, batch, calculator);
+				add_records(batch, values, evaluated);
+			}
+
+			write(path, index, calculator, maxIngredients, evaluated);
+			return{ evaluated.size(), reusedCount, changed.size() };
+		}
+
+		CONSTEXPR const RecipeDatabaseHeader& GetHeader() const noexcept { return *header; }
+		CONSTEXPR size_t size() const noexcept { return recipes.size(); }
+		/// @brief	Gets every recipe, grouped by signature.
+		CONSTEXPR std::span<const RecipeRecord> GetRecipes() const noexcept { return recipes; }
+		/// @brief	Gets every signature, sorted by their effects.
+		CONSTEXPR std::span<const SignatureRecord> GetSignatures() const noexcept { return signatures; }
+
+		/**
+		 * @brief				Checks if the database was built for a registry & calculator.
+		 * @param index			The index of the registry.
+		 * @param calculator	The compiled game settings & perks.
+		 * @returns				True when the database has the same recipes that would be built from them.
+		 */
+		bool IsCurrent(RegistryIndex const& index, PotionCalculator const& calculator) const
+		{
+			return header->registryFingerprint == get_registry_fingerprint(index) && header->calculatorFingerprint == calculator.GetFingerprint();
+		}
+
+		/**
+		 * @brief			Finds every recipe that produces exactly a set of effects, with a binary search of the signatures.
+		 * @param signature	The effects.
+		 * @returns			The recipes in lexicographic order, or an empty span if no recipe produces exactly those effects.
+		 */
+		std::span<const RecipeRecord> Find(EffectSignature const& signature) const noexcept
+		{
+			const auto& it{ std::ranges::lower_bound(signatures, signature.GetEffectIDs(), [](auto&& l, auto&& r) { return std::ranges::lexicographical_compare(l, r); }, &SignatureRecord::GetEffectIDs) };
+			if (it == signatures.end() || !std::ranges::equal(it->GetEffectIDs(), signature.GetEffectIDs()))
+				return{};
+			return recipes.subspan(it->first, it->count);
+		}
+
+		/// @brief	Gets the positions of every recipe that has an effect, ordered from that effect's strongest magnitude to its weakest.
+		CONSTEXPR std::span<const std::uint32_t> GetRecipesWithEffect(const EffectID id) const noexcept
+		{
+			if (id >= header->effectCount)
+				return{};
+			return effectRecipes.subspan(effectOffsets[id], effectOffsets[id + 1] - effectOffsets[id]);
+		}
+
+		/**
+		 * @brief			Finds the best recipes that have every one of a set of effects, scored like RecipeSolver scores them.
+		 *					Only the recipes of the effect with the fewest recipes are scanned; when there's only one effect &
+		 *					 the objective is its magnitude, the scan stops as soon as no other recipe can be better.
+		 * @param effectIDs	The effects that every recipe must have. Must not be empty.
+		 * @param objective	What to maximize.
+		 * @param count		The maximum number of recipes to return.
+		 * @returns			Up to count results, ordered from best to worst.
+		 */
+		std::vector<DatabaseResult> FindBest(std::span<const EffectID> effectIDs, const ESolverObjective objective, const size_t count) const
+		{
+			if (effectIDs.empty())
+				throw make_exception("At least one effect is required to find the best recipes!");
+			if (count == 0)
+				return{};
+			auto shortest{ GetRecipesWithEffect(effectIDs.front()) };
+			for (const auto& id : effectIDs)
+				if (const auto& candidates{ GetRecipesWithEffect(id) }; candidates.size() < shortest.size())
+					shortest = candidates;
+
+			const bool sorted{ effectIDs.size() == 1 && objective == ESolverObjective::Magnitude };
+			BoundedHeap<DatabaseResult, ResultOrder> best{ count };
+			for (const auto& position : shortest) {
+				const auto& record{ recipes[position] };
+				float wanted{ 0.0f }, unwanted{ 0.0f };
+				unsigned duration{ 0 };
+				size_t matched{ 0 };
+				for (size_t e{ 0 }; e < record.effectCount; ++e) {
+					if (std::ranges::find(effectIDs, record.effectIDs[e]) != effectIDs.end()) {
+						wanted += record.magnitudes[e];
+						duration += record.durations[e];
+						++matched;
+					}
+					else unwanted += std::max(0.0f, record.magnitudes[e]);
+				}
+				if (matched != effectIDs.size())
+					continue;
+
+				float score{ wanted };
+				if (objective == ESolverObjective::Duration)
+					score = $c(float, duration);
+				else if (objective == ESolverObjective::Value)
+					score = $c(float, record.value);
+				else if (objective == ESolverObjective::Purity)
+					score = wanted - unwanted;
+				if (!best.Push(DatabaseResult{ &record, score }) && sorted && score < best.GetWorst().score)
+					break;
+			}
+			return best.TakeSorted();
+		}
+
+		/**
+		 * @brief			Gets a recipe as a potion, so it can be named & materialized.
+		 * @param index		The index of the registry that the database was built for.
+		 * @param record	A recipe in this database.
+		 * @returns			A PotionHandle of the potion.
+		 */
+		static PotionHandle GetPotion(RegistryIndex const& index, RecipeRecord const& record)
+		{
+			Recipe recipe;
+			for (const auto& id : record.GetIngredients())
+				recipe.ingredients[recipe.count++] = id;
+			PotionHandle potion{ index, recipe };
+			potion.classes = $c(EPotionClass, record.classes);
+			potion.count = record.effectCount;
+			std::ranges::copy(record.GetEffectIDs(), potion.effectIDs.begin());
+			std::ranges::copy(record.GetMagnitudes(), potion.magnitudes.begin());
+			std::ranges::copy(record.GetDurations(), potion.durations.begin());
+			return potion;
+		}
+	};
+}
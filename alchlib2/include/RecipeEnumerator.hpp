@@ -0,0 +1,265 @@
+#pragma once
+#include "CompatibilityMatrix.hpp"
+#include "PotionBuilder.hpp"
+#include "WorkStealingPool.hpp"
+
+#include <make_exception.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <deque>
+#include <future>
+#include <numeric>
+#include <utility>
+
+namespace alchlib2 {
+	/**
+	 * @brief		Generates every useful combination of ingredients in a registry, in lexicographic order of their IngredientIDs.
+	 *				A combination is useful when each of its ingredients shares at least one effect with another ingredient
+	 *				 in the combination; adding an ingredient that doesn't would only waste it.
+	 *				Candidates are pruned by combining rows of the CompatibilityMatrix's bitsets, so ingredients that can't
+	 *				 complete a useful combination are never visited. The matrix must outlive the enumerator.
+	 *				Enumeration can be limited to a subset of the registry's ingredients, such as an inventory, & to the recipes that
+	 *				 use at least one of another subset, such as the ingredients that changed since the last enumeration.
+	 */
+	class RecipeEnumerator {
+		const CompatibilityMatrix* matrix;
+		size_t minIngredients;
+		size_t maxIngredients;
+		/// @brief	The ingredients that can be used, sorted by IngredientID.
+		std::vector<IngredientID> ingredients;
+		/// @brief	The same ingredients as a bitset, in the same layout as CompatibilityMatrix::GetCompatibleBits.
+		std::vector<std::uint64_t> allowed;
+		/// @brief	Recipes must use at least one of these ingredients, in the same layout as allowed. Empty when every recipe is used.
+		std::vector<std::uint64_t> required;
+		/// @brief	The greatest required ingredient, so prefixes after it can be skipped.
+		IngredientID lastRequired{ 0 };
+		/// @brief	The ingredients that share an effect with a required ingredient, in the same layout as allowed.
+		std::vector<std::uint64_t> nearRequired;
+
+		/// @brief	Checks if an ingredient is required, or if no ingredients are required.
+		CONSTEXPR bool is_required(const IngredientID id) const noexcept { return required.empty() || ((required[id / 64] >> (id % 64)) & 1); }
+		/// @brief	Checks if any recipe that starts with the ingredients a & b can use a required ingredient.
+		CONSTEXPR bool can_use_required(const IngredientID a, const IngredientID b) const noexcept
+		{
+			if (is_required(a) || is_required(b))
+				return true;
+			if (maxIngredients < 3 || lastRequired <= b)
+				return false;
+			// with 3 ingredients, the required one must be the last & share an effect with a or b
+			return maxIngredients >= 4 || ((nearRequired[a / 64] >> (a % 64)) & 1) || ((nearRequired[b / 64] >> (b % 64)) & 1);
+		}
+
+		/// @brief	Calls func with the position of every set bit in mask that is greater than after.
+		template<typename TFunc>
+		static void for_each_bit_after(std::span<const std::uint64_t> mask, const IngredientID after, TFunc&& func)
+		{
+			const size_t first{ $c(size_t, after) + 1 };
+			for (size_t w{ first / 64 }; w < mask.size(); ++w) {
+				auto word{ mask[w] };
+				if (w == first / 64)
+					word &= ~std::uint64_t{ 0 } << (first % 64);
+				for (; word != 0; word &= word - 1)
+					func($c(IngredientID, w * 64 + $c(size_t, std::countr_zero(word))));
+			}
+		}
+
+		/**
+		 * @brief			Generates every useful combination that starts with the ingredients a & b, in lexicographic order.
+		 * @param a			The first ingredient.
+		 * @param b			The second ingredient, which must be greater than a.
+		 * @param mask		Scratch space with room for one row of bits.
+		 * @param onRecipe	Called with each Recipe.
+		 */
+		template<typename TFunc>
+		void enumerate_prefix(const IngredientID a, const IngredientID b, std::vector<std::uint64_t>& mask, TFunc&& onRecipe) const
+		{
+			const bool ab{ matrix->IsCompatible(a, b) };
+			const bool requiredAB{ is_required(a) || is_required(b) };
+			if (ab && requiredAB && minIngredients <= 2)
+				onRecipe(Recipe{ a, b });
+			if (maxIngredients < 3)
+				return;
+
+			const auto bitsA{ matrix->GetCompatibleBits(a) };
+			const auto bitsB{ matrix->GetCompatibleBits(b) };
+			const auto visit{ [&](const IngredientID c) {
+				const bool ac{ matrix->IsCompatible(a, c) }, bc{ matrix->IsCompatible(b, c) };
+				const bool partnerA{ ab || ac }, partnerB{ ab || bc }, partnerC{ ac || bc };
+				const bool requiredABC{ requiredAB || is_required(c) };
+				if (partnerA && partnerB && partnerC && requiredABC && minIngredients <= 3)
+					onRecipe(Recipe{ a, b, c });
+				if (maxIngredients < 4)
+					return;
+
+				// the last ingredient needs a partner, and must be the partner of every ingredient that doesn't have one yet
+				const auto bitsC{ matrix->GetCompatibleBits(c) };
+				for (size_t w{ 0 }; w < mask.size(); ++w) {
+					auto word{ (bitsA[w] | bitsB[w] | bitsC[w]) & allowed[w] };
+					if (!partnerA) word &= bitsA[w];
+					if (!partnerB) word &= bitsB[w];
+					if (!partnerC) word &= bitsC[w];
+					if (!requiredABC) word &= required[w];
+					mask[w] = word;
+				}
+				for_each_bit_after(mask, c, [&](const IngredientID d) { onRecipe(Recipe{ a, b, c, d }); });
+			} };
+
+			if (maxIngredients >= 4) {
+				// a third ingredient without a partner can still be completed by the fourth
+				for_each_bit_after(allowed, b, visit);
+				return;
+			}
+			std::vector<std::uint64_t> candidates(mask.size());
+			for (size_t w{ 0 }; w < candidates.size(); ++w)
+				candidates[w] = (ab ? (bitsA[w] | bitsB[w]) : (bitsA[w] & bitsB[w])) & allowed[w] & (requiredAB ? ~std::uint64_t{ 0 } : required[w]);
+			for_each_bit_after(candidates, b, visit);
+		}
+
+	public:
+		/**
+		 * @brief					Creates an enumerator for the registry that the given matrix was built from.
+		 * @param matrix			The compatibility matrix of the registry.
+		 * @param minIngredients	The minimum number of ingredients per recipe.
+		 * @param maxIngredients	The maximum number of ingredients per recipe. The game allows up to 3.
+		 */
+		RecipeEnumerator(CompatibilityMatrix const& matrix, const size_t minIngredients = 2, const size_t maxIngredients = 3) :
+			matrix{ &matrix },
+			minIngredients{ minIngredients },
+			maxIngredients{ maxIngredients },
+			ingredients(matrix.size()),
+			allowed(matrix.GetWordCount(), 0u)
+		{
+			if (minIngredients < 2 || maxIngredients > MAX_POTION_INGREDIENTS || minIngredients > maxIngredients)
+				throw make_exception("Invalid number of ingredients per recipe: ", minIngredients, " to ", maxIngredients, "! (Must be within 2 to ", MAX_POTION_INGREDIENTS, ")");
+			std::iota(ingredients.begin(), ingredients.end(), IngredientID{ 0 });
+			for (const auto& id : ingredients)
+				allowed[id / 64] |= std::uint64_t{ 1 } << (id % 64);
+		}
+		/**
+		 * @brief					Creates an enumerator that only uses the specified ingredients.
+		 * @param matrix			The compatibility matrix of the registry.
+		 * @param ingredients		The ingredients that can be used. Duplicates are ignored.
+		 * @param minIngredients	The minimum number of ingredients per recipe.
+		 * @param maxIngredients	The maximum number of ingredients per recipe. The game allows up to 3.
+		 */
+		RecipeEnumerator(CompatibilityMatrix const& matrix, std::span<const IngredientID> ingredients, const size_t minIngredients = 2, const size_t maxIngredients = 3) :
+			RecipeEnumerator(matrix, minIngredients, maxIngredients)
+		{
+			std::ranges::fill(allowed, 0u);
+			for (const auto& id : ingredients) {
+				if (id >= matrix.size())
+					throw make_exception("Invalid ingredient ID ", id, "! (The registry has ", matrix.size(), " ingredients)");
+				allowed[id / 64] |= std::uint64_t{ 1 } << (id % 64);
+			}
+			this->ingredients.clear();
+			for (IngredientID id{ 0 }; id < matrix.size(); ++id)
+				if ((allowed[id / 64] >> (id % 64)) & 1)
+					this->ingredients.emplace_back(id);
+		}
+
+		/**
+		 * @brief				Limits enumeration to the recipes that use at least one of the specified ingredients.
+		 *						Prefixes that can't use any of them are skipped entirely, so enumerating the recipes of a few
+		 *						 ingredients only takes a fraction of the time of enumerating every recipe.
+		 * @param ingredients	The required ingredients. Duplicates are ignored. When empty, no recipes are enumerated.
+		 */
+		void RequireAny(std::span<const IngredientID> ingredients)
+		{
+			required.assign(allowed.size(), 0u);
+			lastRequired = 0;
+			for (const auto& id : ingredients) {
+				if (id >= matrix->size())
+					throw make_exception("Invalid ingredient ID ", id, "! (The registry has ", matrix->size(), " ingredients)");
+				required[id / 64] |= std::uint64_t{ 1 } << (id % 64);
+				lastRequired = std::max(lastRequired, id);
+			}
+			nearRequired.assign(allowed.size(), 0u);
+			for (IngredientID id{ 0 }; id < matrix->size(); ++id) {
+				const auto bits{ matrix->GetCompatibleBits(id) };
+				for (size_t w{ 0 }; w < required.size(); ++w) {
+					if (bits[w] & required[w]) {
+						nearRequired[id / 64] |= std::uint64_t{ 1 } << (id % 64);
+						break;
+					}
+				}
+			}
+			// an empty bitset would mean that every recipe is used
+			if (ingredients.empty())
+				required.emplace_back(0u);
+		}
+
+		/**
+		 * @brief			Calls onRecipe with every useful recipe, in lexicographic order, on the calling thread.
+		 * @param onRecipe	A callable that accepts a Recipe.
+		 */
+		template<typename TFunc>
+		void ForEachRecipe(TFunc&& onRecipe) const
+		{
+			std::vector<std::uint64_t> mask(matrix->GetWordCount());
+			for (size_t a{ 0 }; a < ingredients.size(); ++a)
+				for (size_t b{ a + 1 }; b < ingredients.size(); ++b)
+					if (can_use_required(ingredients[a], ingredients[b]))
+						enumerate_prefix(ingredients[a], ingredients[b], mask, onRecipe);
+		}
+
+		/**
+		 * @brief				Enumerates & evaluates every useful recipe on a work-stealing thread pool.
+		 *						Each pair of first ingredients is evaluated as one task, and the results are passed to onBatch
+		 *						 on the calling thread in lexicographic order as soon as they're ready, so the output is
+		 *						 deterministic & only a bounded number of batches are kept in memory.
+		 * @param builder		The builder to evaluate recipes with.
+		 * @param calculator	The compiled game settings & perks to apply.
+		 * @param onBatch		A callable that accepts a const PotionBatch&. Empty batches are skipped.
+		 * @param threadCount	The number of worker threads. 0 uses one thread per hardware thread.
+		 */
+		template<typename TFunc>
+		void Run(PotionBuilder const& builder, PotionCalculator const& calculator, TFunc&& onBatch, const unsigned threadCount = 0) const
+		{
+			const auto& index{ matrix->GetIndex() };
+			const auto n{ ingredients.size() };
+
+			WorkStealingPool pool{ threadCount };
+			// limits how far the workers can get ahead of onBatch
+			const size_t window{ pool.size() * 16 };
+			std::deque<std::future<PotionBatch>> inFlight;
+
+			// positions in ingredients of the next prefix
+			size_t a{ 0 }, b{ 1 };
+			const auto advance{ [&]() {
+				if (++b == n) {
+					++a;
+					b = a + 1;
+				}
+			} };
+			const auto submit_next{ [&]() -> bool {
+				// prefixes that can't use a required ingredient don't need a task
+				while (b < n && !can_use_required(ingredients[a], ingredients[b]))
+					advance();
+				if (b >= n)
+					return false;
+				auto task{ std::make_shared<std::packaged_task<PotionBatch()>>([this, &builder, &calculator, &index, a = ingredients[a], b = ingredients[b]]() {
+					std::vector<Recipe> recipes;
+					std::vector<std::uint64_t> mask(matrix->GetWordCount());
+					enumerate_prefix(a, b, mask, [&recipes](Recipe const& recipe) { recipes.emplace_back(recipe); });
+					PotionBatch batch{ index };
+					builder.BuildMany(recipes, batch, calculator);
+					return batch;
+				}) };
+				inFlight.emplace_back(task->get_future());
+				pool.Submit([task]() { (*task)(); });
+				advance();
+				return true;
+			} };
+
+			while (inFlight.size() < window && submit_next()) {}
+			while (!inFlight.empty()) {
+				const auto batch{ inFlight.front().get() };
+				inFlight.pop_front();
+				submit_next();
+				if (!batch.empty())
+					onBatch(batch);
+			}
+		}
+	};
+}
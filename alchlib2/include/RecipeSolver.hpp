@@ -0,0 +1,641 @@
+#pragma once
+#include "BoundedHeap.hpp"
+#include "CompatibilityMatrix.hpp"
+#include "IngredientClasses.hpp"
+#include "PotionBuilder.hpp"
+#include "PotionValue.hpp"
+#include "ParetoFrontier.hpp"
+#include "PotionCache.hpp"
+#include "RecipeEnumerator.hpp"
+
+#include <make_exception.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <numeric>
+#include <thread>
+
+namespace alchlib2 {
+	/// @brief	The value that RecipeSolver maximizes.
+	enum class ESolverObjective : std::uint8_t {
+		/// @brief	The total magnitude of the wanted effects.
+		Magnitude,
+		/// @brief	The total duration of the wanted effects.
+		Duration,
+		/// @brief	The gold value of the potion, including unwanted effects.
+		Value,
+		/// @brief	The total magnitude of the wanted effects, minus the total magnitude of every other effect.
+		Purity,
+	};
+
+	/**
+	 * @brief		Gets the objective with the specified name.
+	 * @param name	"magnitude", "duration", "value" or "purity". This is not case-sensitive.
+	 * @returns		The ESolverObjective with the specified name.
+	 */
+	inline ESolverObjective get_solver_objective(const std::string& name)
+	{
+		const auto& lower{ str::tolower(name) };
+		if (lower == "magnitude" || lower == "mag")
+			return ESolverObjective::Magnitude;
+		else if (lower == "duration" || lower == "dur")
+			return ESolverObjective::Duration;
+		else if (lower == "value")
+			return ESolverObjective::Value;
+		else if (lower == "purity")
+			return ESolverObjective::Purity;
+		throw make_exception("Invalid objective '", name, "'! (Expected magnitude, duration, value or purity)");
+	}
+	/// @brief	Gets the name of the specified objective, as accepted by get_solver_objective.
+	inline std::string get_solver_objective_name(const ESolverObjective objective)
+	{
+		switch (objective) {
+		case ESolverObjective::Magnitude:
+			return "magnitude";
+		case ESolverObjective::Duration:
+			return "duration";
+		case ESolverObjective::Value:
+			return "value";
+		case ESolverObjective::Purity:
+			return "purity";
+		}
+		return{};
+	}
+
+	/// @brief	The constraints & objective of a RecipeSolver search.
+	struct SolverQuery {
+		/// @brief	Effects that every result must have.
+		std::vector<EffectID> required;
+		/// @brief	Effects that results must not have.
+		std::vector<EffectID> forbidden;
+		/// @brief	Effects that add to the score, but aren't required. When both this & required are empty, every effect is wanted.
+		std::vector<EffectID> optional;
+		/// @brief	When true, results must not have any harmful effects.
+		bool excludeHarmful{ false };
+		ESolverObjective objective{ ESolverObjective::Magnitude };
+		/// @brief	The maximum number of ingredients per recipe.
+		size_t maxIngredients{ 3 };
+		/// @brief	The maximum number of results.
+		size_t count{ 10 };
+		/// @brief	When set, recipes are only searched over the candidates of each class of equivalent ingredients, & only the
+		///			 canonical recipe of each set of equivalent recipes is returned. The classes must outlive the search.
+		const IngredientClasses* classes{ nullptr };
+	};
+
+	/// @brief	A recipe found by RecipeSolver, with its evaluated potion & score.
+	struct SolverResult {
+		PotionHandle potion;
+		float score;
+	};
+
+	/**
+	 * @brief		Finds the best recipes for a set of wanted effects with a depth-first branch-and-bound search.
+	 *				Each ingredient gets an upper bound on how much it can add to the score, from the strongest possible version
+	 *				 of each of its wanted effects; a branch is abandoned as soon as the bounds of its ingredients plus the best
+	 *				 remaining ones can't beat the current results, or when a required effect can't occur twice anymore.
+	 *				Like RecipeEnumerator, only recipes where each ingredient shares an effect with another one are returned.
+	 *				The matrix, builder & calculator must outlive the solver.
+	 */
+	class RecipeSolver {
+		/// @brief	What an effect means for the current query.
+		enum class ERole : std::uint8_t {
+			Unwanted,
+			Wanted,
+			Forbidden,
+		};
+
+		const CompatibilityMatrix* matrix;
+		const PotionBuilder* builder;
+		const PotionCalculator* calculator;
+		PotionCache* cache;
+
+		/// @brief	Orders results by score, then by their ingredients.
+		struct ResultOrder {
+			bool operator()(SolverResult const& l, SolverResult const& r) const noexcept
+			{
+				if (l.score != r.score)
+					return l.score > r.score;
+				return std::ranges::lexicographical_compare(l.potion.GetRecipe().GetIngredients(), r.potion.GetRecipe().GetIngredients());
+			}
+		};
+
+		/// @brief	The state of a single search, or of one thread of a parallel search.
+		struct Search {
+			/// @brief	The query, with duplicate effects removed.
+			SolverQuery query;
+			std::vector<ERole> roles;
+			/// @brief	The ingredients that can be used, sorted by their bound in descending order.
+			std::vector<IngredientID> pool;
+			/// @brief	The sum of the bounds of the first n ingredients in pool, indexed by n.
+			std::vector<float> prefixBounds;
+			/// @brief	The bound of each effect slot of each ingredient in pool, indexed by position.
+			std::vector<std::array<float, MAX_INGREDIENT_EFFECTS>> slotBounds;
+			/// @brief	The largest slot bound of each effect in pool, indexed by EffectID.
+			std::vector<float> effectBounds;
+			/// @brief	The number of ingredients in pool at or after each position that have each required effect, indexed by (required * (pool.size() + 1) + position).
+			std::vector<unsigned> suffixCounts;
+			/// @brief	Whether each ingredient in pool has each required effect, indexed by (position * required.size() + required).
+			std::vector<std::uint8_t> hasRequired;
+			/// @brief	The best results so far.
+			BoundedHeap<SolverResult, ResultOrder> results;
+			/// @brief	The best score that every thread's results must beat, when searching on multiple threads.
+			///			Each thread publishes the worst of its results once it has query.count of them, which the final results
+			///			 can't be worse than, so every thread can prune with the best one.
+			std::atomic<float>* sharedThreshold{ nullptr };
+
+			std::array<size_t, MAX_POTION_INGREDIENTS> chosen{};
+			std::array<std::uint8_t, MAX_COMMON_EFFECTS> requiredCounts{};
+			size_t depth{ 0 };
+			float chosenBound{ 0.0f };
+
+			Search(SolverQuery const& query) : query{ query }, results{ query.count }
+			{
+				for (auto* effects : { &this->query.required, &this->query.forbidden, &this->query.optional }) {
+					std::ranges::sort(*effects);
+					effects->erase(std::unique(effects->begin(), effects->end()), effects->end());
+				}
+			}
+		};
+
+		/**
+		 * @brief			Scores a potion for the current query.
+		 * @param search	The current search.
+		 * @param potion	The evaluated potion.
+		 * @param objective	The objective to score the potion for.
+		 * @returns			The score of the potion, or std::nullopt if it doesn't satisfy the query.
+		 */
+		static std::optional<float> score(Search const& search, PotionHandle const& potion, const ESolverObjective objective) noexcept
+		{
+			const auto effectIDs{ potion.GetEffectIDs() };
+			const auto magnitudes{ potion.GetMagnitudes() };
+			const auto durations{ potion.GetDurations() };
+
+			size_t wanted{ 0 }, required{ 0 };
+			float total{ 0.0f };
+			for (size_t e{ 0 }; e < effectIDs.size(); ++e) {
+				const auto& role{ search.roles[effectIDs[e]] };
+				if (role == ERole::Forbidden)
+					return std::nullopt;
+				if (role == ERole::Wanted) {
+					++wanted;
+					if (std::ranges::find(search.query.required, effectIDs[e]) != search.query.required.end())
+						++required;
+				}
+
+				switch (objective) {
+				case ESolverObjective::Magnitude:
+					if (role == ERole::Wanted) total += magnitudes[e];
+					break;
+				case ESolverObjective::Duration:
+					if (role == ERole::Wanted) total += $c(float, durations[e]);
+					break;
+				case ESolverObjective::Value:
+					break;
+				case ESolverObjective::Purity:
+					if (role == ERole::Wanted) total += magnitudes[e];
+					else total -= std::max(0.0f, magnitudes[e]);
+					break;
+				}
+			}
+			if (wanted == 0 || required != search.query.required.size())
+				return std::nullopt;
+			if (objective == ESolverObjective::Value)
+				total = $c(float, get_potion_value(potion));
+			return total;
+		}
+
+		/**
+		 * @brief			Checks if a bound can still beat the worst of the current results, or if there's room for more results.
+		 *					Bounds & scores are summed in different orders, so the bound must beat it by more than rounding errors.
+		 */
+		static bool can_beat(Search const& search, const float bound) noexcept
+		{
+			auto threshold{ -std::numeric_limits<float>::infinity() };
+			if (search.results.IsFull())
+				threshold = search.results.GetWorst().score;
+			if (search.sharedThreshold != nullptr)
+				threshold = std::max(threshold, search.sharedThreshold->load(std::memory_order_relaxed));
+			if (threshold == -std::numeric_limits<float>::infinity())
+				return true;
+			return bound > threshold + 1e-5f * std::max(1.0f, std::abs(threshold));
+		}
+
+		/// @brief	Adds a potion to the results when it satisfies the query & is one of the best so far.
+		static void offer(Search& search, PotionHandle const& potion)
+		{
+			const auto& s{ score(search, potion, search.query.objective) };
+			if (!s.has_value())
+				return;
+			if (!search.results.Push(SolverResult{ potion, s.value() }) || !search.results.IsFull() || search.sharedThreshold == nullptr)
+				return;
+			const auto worst{ search.results.GetWorst().score };
+			auto shared{ search.sharedThreshold->load(std::memory_order_relaxed) };
+			while (worst > shared && !search.sharedThreshold->compare_exchange_weak(shared, worst, std::memory_order_relaxed)) {}
+		}
+
+		/// @brief	Checks if each of the chosen ingredients shares an effect with another one.
+		bool all_partnered(Search const& search) const noexcept
+		{
+			for (size_t i{ 0 }; i < search.depth; ++i) {
+				bool partnered{ false };
+				for (size_t j{ 0 }; !partnered && j < search.depth; ++j)
+					partnered = i != j && matrix->IsCompatible(search.pool[search.chosen[i]], search.pool[search.chosen[j]]);
+				if (!partnered)
+					return false;
+			}
+			return true;
+		}
+
+		/**
+		 * @brief			Checks if every required effect can still occur at least twice.
+		 * @param search	The current search.
+		 * @param from		The first position in the pool that can still be chosen.
+		 */
+		static bool is_feasible(Search const& search, const size_t from) noexcept
+		{
+			const auto remaining{ search.query.maxIngredients - search.depth };
+			for (size_t r{ 0 }; r < search.query.required.size(); ++r) {
+				if (search.requiredCounts[r] >= 2)
+					continue;
+				const size_t available{ search.suffixCounts[r * (search.pool.size() + 1) + from] };
+				if (2u - search.requiredCounts[r] > std::min(remaining, available))
+					return false;
+			}
+			return true;
+		}
+
+		/**
+		 * @brief			Gets a bound for the chosen ingredients plus one more, using only the effect slots that they share.
+		 *					Only the strongest occurrence of each common effect counts, & it's always on a shared slot, so this is
+		 *					 much tighter than the bounds of whole ingredients once the last ingredient is being chosen.
+		 * @param search	The current search.
+		 * @param next		The position in the pool of the last ingredient.
+		 */
+		float get_shared_bound(Search const& search, const size_t next) const noexcept
+		{
+			const auto& index{ matrix->GetIndex() };
+			std::array<size_t, MAX_POTION_INGREDIENTS> positions{};
+			std::copy_n(search.chosen.begin(), search.depth, positions.begin());
+			positions[search.depth] = next;
+			const auto count{ search.depth + 1 };
+
+			std::array<std::pair<EffectID, float>, MAX_POTION_INGREDIENTS * MAX_INGREDIENT_EFFECTS> strongest{};
+			size_t effectCount{ 0 };
+			for (size_t i{ 0 }; i < count; ++i) {
+				const auto& id{ search.pool[positions[i]] };
+				std::uint8_t slots{ 0 };
+				for (size_t j{ 0 }; j < count; ++j)
+					if (i != j)
+						slots |= matrix->GetSharedSlots(id, search.pool[positions[j]]);
+
+				for (std::uint8_t slot{ 0 }; slot < MAX_INGREDIENT_EFFECTS; ++slot) {
+					if (((slots >> slot) & 1) == 0)
+						continue;
+					const auto& effectID{ index.GetEffectIDs(id)[slot] };
+					const auto& bound{ search.slotBounds[positions[i]][slot] };
+					const auto it{ std::find_if(strongest.begin(), strongest.begin() + effectCount, [&effectID](auto&& pr) { return pr.first == effectID; }) };
+					if (it == strongest.begin() + effectCount)
+						strongest[effectCount++] = { effectID, bound };
+					else
+						it->second = std::max(it->second, bound);
+				}
+			}
+
+			float bound{ 0.0f };
+			for (size_t e{ 0 }; e < effectCount; ++e)
+				bound += strongest[e].second;
+			return bound;
+		}
+
+		/**
+		 * @brief			Gets a bound for the chosen ingredients plus one more, when exactly one ingredient can be added after that.
+		 *					Each effect is counted once with the strongest occurrence in the pool, & the last ingredient can only
+		 *					 complete as many effects that occur once as it has effects.
+		 * @param search	The current search.
+		 * @param next		The position in the pool of the ingredient being added.
+		 */
+		float get_partial_bound(Search const& search, const size_t next) const noexcept
+		{
+			const auto& index{ matrix->GetIndex() };
+			std::array<std::pair<EffectID, std::uint8_t>, MAX_POTION_INGREDIENTS * MAX_INGREDIENT_EFFECTS> occurrences{};
+			size_t effectCount{ 0 };
+			for (size_t i{ 0 }; i <= search.depth; ++i) {
+				for (const auto& effectID : index.GetEffectIDs(search.pool[i < search.depth ? search.chosen[i] : next])) {
+					const auto it{ std::find_if(occurrences.begin(), occurrences.begin() + effectCount, [&effectID](auto&& pr) { return pr.first == effectID; }) };
+					if (it == occurrences.begin() + effectCount)
+						occurrences[effectCount++] = { effectID, 1 };
+					else
+						++it->second;
+				}
+			}
+
+			float bound{ 0.0f };
+			std::array<float, MAX_POTION_INGREDIENTS * MAX_INGREDIENT_EFFECTS> singles{};
+			size_t singleCount{ 0 };
+			for (size_t e{ 0 }; e < effectCount; ++e) {
+				const auto& [effectID, count] { occurrences[e] };
+				if (count >= 2)
+					bound += search.effectBounds[effectID];
+				else
+					singles[singleCount++] = search.effectBounds[effectID];
+			}
+			const auto completed{ std::min(singleCount, MAX_INGREDIENT_EFFECTS) };
+			std::partial_sort(singles.begin(), singles.begin() + completed, singles.begin() + singleCount, std::greater<float>{});
+			return std::accumulate(singles.begin(), singles.begin() + completed, bound);
+		}
+
+		/// @brief	Evaluates the chosen ingredients, then tries adding each remaining ingredient from the given position.
+		void search_from(Search& search, const size_t from) const
+		{
+			if (search.depth >= 2) {
+				std::array<IngredientID, MAX_POTION_INGREDIENTS> ids{};
+				for (size_t i{ 0 }; i < search.depth; ++i)
+					ids[i] = search.pool[search.chosen[i]];
+				std::sort(ids.begin(), ids.begin() + search.depth);
+				Recipe recipe;
+				for (size_t i{ 0 }; i < search.depth; ++i)
+					recipe.ingredients[recipe.count++] = ids[i];
+
+				const auto& potion{ cache != nullptr ? cache->Evaluate(*builder, *calculator, recipe) : builder->Evaluate(matrix->GetIndex(), recipe, *calculator) };
+				if (all_partnered(search))
+					offer(search, potion);
+				// common effects never disappear when ingredients are added, unless Purity removes them
+				if (!calculator->IsPurityEnabled() && std::ranges::any_of(potion.GetEffectIDs(), [&search](auto&& id) { return search.roles[id] == ERole::Forbidden; }))
+					return;
+			}
+			if (search.depth == search.query.maxIngredients)
+				return;
+
+			for (size_t next{ from }; next < search.pool.size(); ++next)
+				if (!search_with(search, next))
+					break;
+		}
+
+		/**
+		 * @brief			Adds an ingredient to the chosen ones & searches every recipe that can follow it.
+		 * @param search	The current search.
+		 * @param next		The position in the pool of the ingredient to add.
+		 * @returns			False when neither this ingredient nor any of the following ones in the pool can beat the results.
+		 */
+		bool search_with(Search& search, const size_t next) const
+		{
+			// the pool is sorted by bound, so once one ingredient can't beat the threshold none of the following ones can either
+			const auto remaining{ search.query.maxIngredients - search.depth };
+			const auto best{ search.prefixBounds[std::min(search.pool.size(), next + remaining)] - search.prefixBounds[next] };
+			if (!can_beat(search, search.chosenBound + best))
+				return false;
+
+			// equivalent members have the same bound & are in the pool in ascending order, so the member before this one
+			//  has already been chosen or skipped
+			if (search.query.classes != nullptr) {
+				if (const auto& previous{ search.query.classes->GetPreviousMember(search.pool[next]) }; previous != NullIngredientID
+					&& std::none_of(search.chosen.begin(), search.chosen.begin() + search.depth, [&](auto&& p) { return search.pool[p] == previous; }))
+					return true;
+			}
+			if (remaining == 1 && !can_beat(search, get_shared_bound(search, next)))
+				return true;
+			if (remaining == 2 && !can_beat(search, get_partial_bound(search, next)))
+				return true;
+
+			const auto bound{ search.prefixBounds[next + 1] - search.prefixBounds[next] };
+			search.chosen[search.depth++] = next;
+			search.chosenBound += bound;
+			for (size_t r{ 0 }; r < search.query.required.size(); ++r)
+				search.requiredCounts[r] += search.hasRequired[next * search.query.required.size() + r];
+
+			if (is_feasible(search, next + 1))
+				search_from(search, next + 1);
+
+			for (size_t r{ 0 }; r < search.query.required.size(); ++r)
+				search.requiredCounts[r] -= search.hasRequired[next * search.query.required.size() + r];
+			search.chosenBound -= bound;
+			--search.depth;
+			return true;
+		}
+
+		/// @brief	Calculates how much each ingredient can add to the score, & sorts them into the pool.
+		void build_pool(Search& search) const
+		{
+			const auto& index{ matrix->GetIndex() };
+			const auto maxMultiplier{ search.query.objective == ESolverObjective::Duration ? 1.0f : calculator->GetMaxMagnitudeMultiplier() };
+
+			// the final stats of each occurrence, as PotionBuilder calculates them before perks
+			const auto& get_stats{ [this, &index](const EffectID id, const float magnitude, const unsigned duration) -> std::pair<float, unsigned> {
+				if (index.GetTraits(id).durationBased)
+					return{ magnitude, $c(unsigned, calculator->GetBase(magnitude)) };
+				return{ calculator->GetBase(magnitude), duration };
+			} };
+
+			std::vector<IngredientID> ingredients;
+			if (search.query.classes != nullptr)
+				ingredients = search.query.classes->GetCandidates(search.query.maxIngredients);
+			else {
+				ingredients.resize(matrix->size());
+				std::iota(ingredients.begin(), ingredients.end(), IngredientID{ 0 });
+			}
+
+			// the value objective combines the strongest magnitude & duration of each effect, which may come from different ingredients
+			std::vector<unsigned> maxDurations(index.GetEffectCount(), 0u);
+			if (search.query.objective == ESolverObjective::Value) {
+				for (const auto& i : ingredients) {
+					const auto effectIDs{ index.GetEffectIDs(i) };
+					for (size_t e{ 0 }; e < effectIDs.size(); ++e)
+						maxDurations[effectIDs[e]] = std::max(maxDurations[effectIDs[e]], get_stats(effectIDs[e], index.GetMagnitudes(i)[e], index.GetDurations(i)[e]).second);
+				}
+			}
+
+			std::vector<std::pair<float, IngredientID>> bounds;
+			std::vector<std::array<float, MAX_INGREDIENT_EFFECTS>> slotBounds(matrix->size());
+			for (const auto& i : ingredients) {
+				const auto effectIDs{ index.GetEffectIDs(i) };
+				for (size_t e{ 0 }; e < effectIDs.size(); ++e) {
+					const auto& id{ effectIDs[e] };
+					const auto [magnitude, duration] { get_stats(id, index.GetMagnitudes(i)[e], index.GetDurations(i)[e]) };
+					const bool wanted{ search.roles[id] == ERole::Wanted };
+
+					auto& bound{ slotBounds[i][e] };
+					switch (search.query.objective) {
+					case ESolverObjective::Magnitude:
+					case ESolverObjective::Purity:
+						if (wanted) bound = std::max(0.0f, magnitude * maxMultiplier);
+						break;
+					case ESolverObjective::Duration:
+						if (wanted) bound = $c(float, duration);
+						break;
+					case ESolverObjective::Value: {
+						// forbidden effects are never part of a result
+						if (search.roles[id] == ERole::Forbidden) break;
+						// a magnitude or duration of 0 counts as a factor of 1
+						const auto magnitudeFactor{ std::max(1.0f, std::pow(std::max(0.0f, magnitude * maxMultiplier), 1.1f)) };
+						const auto durationFactor{ std::max(1.0f, std::pow($c(float, maxDurations[id]) / 10.0f, 1.1f)) };
+						bound = std::max(0.0f, index.GetBaseCost(id)) * magnitudeFactor * durationFactor;
+						break;
+					}
+					}
+				}
+				// ingredients without any wanted effects are kept, since their effects can still change which perks apply
+				bounds.emplace_back(std::accumulate(slotBounds[i].begin(), slotBounds[i].end(), 0.0f), i);
+			}
+			std::ranges::sort(bounds, [](auto&& l, auto&& r) { return l.first != r.first ? l.first > r.first : l.second < r.second; });
+
+			const auto& required{ search.query.required };
+			search.pool.reserve(bounds.size());
+			search.prefixBounds.assign(1, 0.0f);
+			search.effectBounds.assign(index.GetEffectCount(), 0.0f);
+			search.hasRequired.assign(bounds.size() * required.size(), 0u);
+			for (size_t p{ 0 }; p < bounds.size(); ++p) {
+				const auto& [bound, id] { bounds[p] };
+				search.pool.emplace_back(id);
+				search.slotBounds.emplace_back(slotBounds[id]);
+				const auto effectIDs{ index.GetEffectIDs(id) };
+				for (size_t e{ 0 }; e < effectIDs.size(); ++e)
+					search.effectBounds[effectIDs[e]] = std::max(search.effectBounds[effectIDs[e]], slotBounds[id][e]);
+				search.prefixBounds.emplace_back(search.prefixBounds.back() + bound);
+				for (size_t r{ 0 }; r < required.size(); ++r)
+					search.hasRequired[p * required.size() + r] = std::ranges::find(index.GetEffectIDs(id), required[r]) != index.GetEffectIDs(id).end();
+			}
+
+			const auto stride{ search.pool.size() + 1 };
+			search.suffixCounts.assign(required.size() * stride, 0u);
+			for (size_t r{ 0 }; r < required.size(); ++r)
+				for (size_t p{ search.pool.size() }; p-- > 0; )
+					search.suffixCounts[r * stride + p] = search.suffixCounts[r * stride + p + 1] + search.hasRequired[p * required.size() + r];
+		}
+
+		/// @brief	Creates the search state for a query & assigns the role of each effect.
+		Search make_search(SolverQuery const& query) const
+		{
+			if (query.maxIngredients < 2 || query.maxIngredients > MAX_POTION_INGREDIENTS)
+				throw make_exception("Invalid number of ingredients per recipe: ", query.maxIngredients, "! (Must be within 2 to ", MAX_POTION_INGREDIENTS, ")");
+
+			const auto& index{ matrix->GetIndex() };
+			Search search{ query };
+			if (search.query.required.size() > MAX_COMMON_EFFECTS)
+				throw make_exception("Potions can't have more than ", MAX_COMMON_EFFECTS, " effects!");
+			const bool everyEffectWanted{ query.required.empty() && query.optional.empty() };
+			search.roles.assign(index.GetEffectCount(), everyEffectWanted ? ERole::Wanted : ERole::Unwanted);
+			for (const auto& id : search.query.required)
+				search.roles[id] = ERole::Wanted;
+			for (const auto& id : search.query.optional)
+				search.roles[id] = ERole::Wanted;
+			for (const auto& id : search.query.forbidden) {
+				if (std::ranges::binary_search(search.query.required, id))
+					throw make_exception("Effect '", index.GetEffectName(id), "' can't be both required & forbidden!");
+				search.roles[id] = ERole::Forbidden;
+			}
+			if (query.excludeHarmful) {
+				for (EffectID id{ 0 }; id < index.GetEffectCount(); ++id) {
+					if ((index.GetTraits(id).classes & EPotionClass::Harmful) == EPotionClass::None)
+						continue;
+					if (std::ranges::binary_search(search.query.required, id))
+						throw make_exception("Effect '", index.GetEffectName(id), "' is harmful, so it can't be required when harmful effects are excluded!");
+					search.roles[id] = ERole::Forbidden;
+				}
+			}
+			return search;
+		}
+
+	public:
+		/**
+		 * @brief				Creates a solver for the registry that the given matrix was built from.
+		 * @param matrix		The compatibility matrix of the registry.
+		 * @param builder		The builder to evaluate recipes with.
+		 * @param calculator	The compiled game settings & perks to apply.
+		 * @param cache			An optional cache to reuse the recipes that Solve evaluates, which must outlive the solver.
+		 *						 Its recipes are in canonical order, so ties between results may be broken differently.
+		 */
+		RecipeSolver(CompatibilityMatrix const& matrix, PotionBuilder const& builder, PotionCalculator const& calculator, PotionCache* cache = nullptr) :
+			matrix{ &matrix },
+			builder{ &builder },
+			calculator{ &calculator },
+			cache{ cache }
+		{}
+
+		/**
+		 * @brief				Finds the best recipes that satisfy a query.
+		 *						On multiple threads, each thread searches the recipes that start with a different ingredient into
+		 *						 its own bounded set of results, which are merged at the end; branches are pruned with the best
+		 *						 threshold of any thread.
+		 * @param query			The constraints & objective of the search.
+		 * @param threadCount	The number of threads to search with. 0 uses one thread per hardware thread.
+		 *						 The cache is only used by single-threaded searches, since it isn't thread-safe.
+		 * @returns				Up to query.count results, ordered from best to worst.
+		 *						When more recipes are tied with the last result, the ones that were found first are kept,
+		 *						 which can vary between runs when searching on multiple threads.
+		 */
+		std::vector<SolverResult> Solve(SolverQuery const& query, unsigned threadCount = 1) const
+		{
+			Search search{ make_search(query) };
+			if (query.count == 0)
+				return{};
+
+			build_pool(search);
+			if (!is_feasible(search, 0))
+				return{};
+
+			if (threadCount == 0)
+				threadCount = std::max(1u, std::thread::hardware_concurrency());
+			threadCount = std::min($c(unsigned, std::max(search.pool.size(), size_t{ 1 })), threadCount);
+			if (threadCount == 1) {
+				search_from(search, 0);
+				return search.results.TakeSorted();
+			}
+
+			// each thread takes the next first ingredient from the pool, so threads that finish early take more of them
+			std::atomic<float> sharedThreshold{ -std::numeric_limits<float>::infinity() };
+			std::atomic<size_t> nextFirst{ 0 };
+			std::vector<Search> searches(threadCount, search);
+			std::vector<std::thread> threads;
+			threads.reserve(threadCount);
+			const RecipeSolver uncached{ *matrix, *builder, *calculator };
+			for (auto& threadSearch : searches) {
+				threadSearch.sharedThreshold = &sharedThreshold;
+				threads.emplace_back([&uncached, &threadSearch, &nextFirst]() {
+					for (size_t first{ nextFirst++ }; first < threadSearch.pool.size(); first = nextFirst++)
+						if (!uncached.search_with(threadSearch, first))
+							break;
+				});
+			}
+			for (auto& thread : threads)
+				thread.join();
+
+			for (auto& threadSearch : searches)
+				search.results.Merge(std::move(threadSearch.results));
+			return search.results.TakeSorted();
+		}
+
+		/**
+		 * @brief				Finds every recipe that satisfies a query & isn't dominated by another one for the given objectives.
+		 *						Recipes are evaluated on a thread pool by a RecipeEnumerator, & inserted into the frontier in lexicographic
+		 *						 order as their batches arrive, so the results are deterministic. query.objective & query.count are ignored.
+		 * @param query			The constraints of the search.
+		 * @param objectives	The objectives to compare, from 1 to MAX_PARETO_OBJECTIVES.
+		 * @param threadCount	The number of worker threads. 0 uses one thread per hardware thread.
+		 * @returns				The frontier, in descending order of the first objective.
+		 */
+		ParetoFrontier SolveFrontier(SolverQuery const& query, std::span<const ESolverObjective> objectives, const unsigned threadCount = 0) const
+		{
+			const Search search{ make_search(query) };
+			ParetoFrontier frontier{ objectives.size() };
+			const auto& enumerator{ query.classes == nullptr ? RecipeEnumerator{ *matrix, 2, query.maxIngredients } : RecipeEnumerator{ *matrix, query.classes->GetCandidates(query.maxIngredients), 2, query.maxIngredients } };
+			enumerator.Run(*builder, *calculator, [&](PotionBatch const& batch) {
+				for (size_t i{ 0 }; i < batch.size(); ++i) {
+					if (!batch.IsValid(i) || (query.classes != nullptr && !query.classes->IsCanonical(batch.GetRecipe(i)))) continue;
+					ParetoPoint point{ PotionHandle{ batch, i } };
+					// a potion that doesn't satisfy the query doesn't satisfy it for any objective
+					bool satisfied{ true };
+					for (size_t d{ 0 }; d < objectives.size() && satisfied; ++d) {
+						const auto& s{ score(search, point.potion, objectives[d]) };
+						satisfied = s.has_value();
+						if (satisfied)
+							point.scores[d] = s.value();
+					}
+					if (satisfied)
+						frontier.Insert(point);
+				}
+			}, threadCount);
+			return frontier;
+		}
+	};
+}
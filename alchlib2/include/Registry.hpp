@@ -1,5 +1,6 @@
 #pragma once
 #include "Ingredient.hpp"
+#include "ResultSet.hpp"
 
 #include <fileio.hpp>
 
@@ -65,9 +66,7 @@ namespace alchlib2 {
 
 		CONSTEXPR Registry copy_if(const std::function<bool(Ingredient)>& pred) const
 		{
-			Registry tmp{};
-			std::copy_if(Ingredients.begin(), Ingredients.end(), std::back_inserter(tmp.Ingredients), pred);
-			return tmp;
+			return{ select_if(pred).Materialize() };
 		}
 
 		CONSTEXPR void apply_inclusive_filter(const std::string& search_term, const bool requireExactMatch, const bool searchIngredients, const bool searchEffects = false, const bool searchKeywords = false)
@@ -93,52 +92,49 @@ namespace alchlib2 {
 
 		CONSTEXPR Registry copy_inclusive_filter(const std::string& search_term, const bool requireExactMatch, const bool searchIngredients, const bool searchEffects = false, const bool searchKeywords = false) const
 		{
-			if (!searchIngredients && !searchEffects && !searchKeywords) return {};
-			return copy_if([&](Ingredient const& ingredient) -> bool {
-				return (searchIngredients && ingredient.IsSimilarTo(search_term, requireExactMatch))
-					|| (searchEffects && ingredient.AnyEffectIsSimilarTo(search_term, requireExactMatch))
-					|| (searchKeywords && ingredient.AnyEffectKeywordIsSimilarTo(search_term, requireExactMatch));
-			});
+			return{ select_inclusive_filter(search_term, requireExactMatch, searchIngredients, searchEffects, searchKeywords).Materialize() };
 		}
 
-		CONSTEXPR const_iterator find_best_fit(std::string name, const bool searchIngredients = true, const bool searchEffects = true) const
+		CONSTEXPR const_iterator find_best_fit(std::string const& name, const bool searchIngredients = true, const bool searchEffects = true) const
 		{
 			std::vector<const_iterator> partialMatches;
 
-			name = str::tolower(name);
+			const auto name_lc{ text::tolower(name) };
+			// 0 when candidate equals name, 1 when candidate contains name, otherwise 2
+			const auto compare{ [&name_lc](std::string const& candidate) -> int {
+				if (text::equals(candidate, name_lc))
+					return 0;
+				return text::find_first(candidate, name_lc) != std::string_view::npos ? 1 : 2;
+			} };
 
 			if (searchIngredients && searchEffects) {
 				for (auto it{ Ingredients.begin() }; it != Ingredients.end(); ++it) {
-					const auto name_lc{ str::tolower(it->name) };
-					if (name_lc == name)
+					if (const auto result{ compare(it->name) }; result == 0)
 						return it;
-					else if ((name_lc.find(name) < name_lc.size()))
+					else if (result == 1)
 						partialMatches.emplace_back(it);
 					else for (auto fx{ it->effects.begin() }; fx != it->effects.end(); ++fx) {
-						const auto lc{ str::tolower(fx->name) };
-						if (lc == name)
+						if (const auto fxResult{ compare(fx->name) }; fxResult == 0)
 							return it;
-						else if ((lc.find(name) < lc.size()))
+						else if (fxResult == 1)
 							partialMatches.emplace_back(it);
 					}
 				}
 			}
 			else if (searchIngredients) {
 				for (auto it{ Ingredients.begin() }; it != Ingredients.end(); ++it) {
-					const auto name_lc{ str::tolower(it->name) };
-					if (name_lc == name)
+					if (const auto result{ compare(it->name) }; result == 0)
 						return it;
-					else if ((name_lc.find(name) < name_lc.size()))
+					else if (result == 1)
 						partialMatches.emplace_back(it);
 				}
 			}
 			else if (searchEffects) {
 				for (auto it{ Ingredients.begin() }; it != Ingredients.end(); ++it) {
 					for (auto fx{ it->effects.begin() }; fx != it->effects.end(); ++fx) {
-						const auto lc{ str::tolower(fx->name) };
-						if (lc == name)
+						if (const auto result{ compare(fx->name) }; result == 0)
 							return it;
-						else if ((lc.find(name) < lc.size()))
+						else if (result == 1)
 							partialMatches.emplace_back(it);
 					}
 				}
@@ -162,6 +158,42 @@ namespace alchlib2 {
 			return tmp;
 		}
 
+	#pragma region Select
+		/// @brief	Gets a result set containing every ingredient in the registry.
+		ResultSet select_all() const
+		{
+			return{ Ingredients, true };
+		}
+		/// @brief	Gets a result set containing each ingredient that the given predicate returns true for.
+		ResultSet select_if(const std::function<bool(Ingredient const&)>& pred) const
+		{
+			ResultSet results{ Ingredients };
+			for (IngredientID i{ 0 }; i < Ingredients.size(); ++i)
+				if (pred(Ingredients[i]))
+					results.insert(i);
+			return results;
+		}
+		/// @brief	Non-copying version of copy_inclusive_filter.
+		ResultSet select_inclusive_filter(const std::string& search_term, const bool requireExactMatch, const bool searchIngredients, const bool searchEffects = false, const bool searchKeywords = false) const
+		{
+			if (!searchIngredients && !searchEffects && !searchKeywords) return{ Ingredients };
+			return select_if([&](Ingredient const& ingredient) -> bool {
+				return (searchIngredients && ingredient.IsSimilarTo(search_term, requireExactMatch))
+					|| (searchEffects && ingredient.AnyEffectIsSimilarTo(search_term, requireExactMatch))
+					|| (searchKeywords && ingredient.AnyEffectKeywordIsSimilarTo(search_term, requireExactMatch));
+			});
+		}
+		/// @brief	Non-copying version of find_best_fit. Ingredients matched by more than one search term are only included once.
+		ResultSet select_best_fit(std::vector<std::string> const& search_terms, const bool searchIngredients = true, const bool searchEffects = true) const
+		{
+			ResultSet results{ Ingredients };
+			for (const auto& it : search_terms)
+				if (const auto& item{ find_best_fit(it, searchIngredients, searchEffects) }; item != Ingredients.end())
+					results.insert($c(IngredientID, std::distance(Ingredients.begin(), item)));
+			return results;
+		}
+	#pragma endregion Select
+
 		NLOHMANN_DEFINE_TYPE_INTRUSIVE(Registry, Ingredients);
 	};
 
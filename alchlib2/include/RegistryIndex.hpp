@@ -0,0 +1,409 @@
+#pragma once
+#include "Registry.hpp"
+#include "TextSearch.hpp"
+#include "EffectTraits.hpp"
+
+#include <strconv.hpp>
+#include <make_exception.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <unordered_map>
+
+namespace alchlib2 {
+	/// @brief	Interned effect name; effects are considered identical when their names match (case-insensitive).
+	using EffectID = std::uint32_t;
+	/// @brief	Interned keyword; keywords are considered identical when their formIDs match (case-insensitive).
+	using KeywordID = std::uint32_t;
+
+	inline constexpr EffectID NullEffectID{ std::numeric_limits<EffectID>::max() };
+
+	/// @brief	A single occurrence of an effect on an ingredient.
+	struct EffectPosting {
+		IngredientID ingredient;
+		/// @brief	The index of the effect in the ingredient's effect list.
+		std::uint8_t slot;
+	};
+
+	/// @brief	A single occurrence of an effect in a sorted stat column.
+	struct RangePosting {
+		float value;
+		IngredientID ingredient;
+		/// @brief	The index of the effect in the ingredient's effect list.
+		std::uint8_t slot;
+	};
+
+	/// @brief	An inclusive range of effect magnitudes or durations.
+	struct StatRange {
+		float min{ -std::numeric_limits<float>::infinity() };
+		float max{ std::numeric_limits<float>::infinity() };
+
+		CONSTEXPR bool IsUnbounded() const noexcept { return min == -std::numeric_limits<float>::infinity() && max == std::numeric_limits<float>::infinity(); }
+		CONSTEXPR bool Contains(const float value) const noexcept { return value >= min && value <= max; }
+	};
+
+	/**
+	 * @brief		Interned lookup tables for a Registry, allowing effect & keyword queries to touch only
+	 *				 the ingredients that actually match instead of scanning the whole registry.
+	 *				The index refers to ingredients by their position in the source registry, so it must be
+	 *				 rebuilt whenever the registry is modified.
+	 */
+	class RegistryIndex {
+		const Registry* registry;
+
+		/// @brief	Ingredient names, indexed by IngredientID.
+		text::NameBlob ingredientNames;
+
+		/// @brief	Lowercase effect names, indexed by EffectID.
+		std::vector<std::string> effectNames;
+		/// @brief	The traits of the first occurrence of each effect, indexed by EffectID.
+		std::vector<EffectTraits> effectTraits;
+		/// @brief	The base cost of the first occurrence of each effect, indexed by EffectID.
+		std::vector<float> effectBaseCosts;
+		/// @brief	Lowercase effect names stored contiguously for substring searches, indexed by EffectID.
+		text::NameBlob effectNameBlob;
+		std::unordered_map<std::string, EffectID> effectLookup;
+		/// @brief	The ingredients that have each effect, indexed by EffectID. Sorted by ingredient.
+		std::vector<std::vector<EffectPosting>> effectPostings;
+		/// @brief	The EffectIDs of each ingredient's effects, indexed by ingredientEffectOffsets.
+		std::vector<EffectID> ingredientEffects;
+		/// @brief	The magnitudes of each ingredient's effects, parallel to ingredientEffects.
+		std::vector<float> ingredientMagnitudes;
+		/// @brief	The durations of each ingredient's effects, parallel to ingredientEffects.
+		std::vector<unsigned> ingredientDurations;
+		std::vector<std::uint32_t> ingredientEffectOffsets;
+
+		/// @brief	The occurrences of each effect sorted by magnitude, indexed by EffectID.
+		std::vector<std::vector<RangePosting>> magnitudeColumns;
+		/// @brief	The occurrences of each effect sorted by duration, indexed by EffectID.
+		std::vector<std::vector<RangePosting>> durationColumns;
+
+		/// @brief	One instance of each unique keyword, indexed by KeywordID.
+		std::vector<Keyword> keywords;
+		/// @brief	Keyword names & formIDs stored contiguously for substring searches. Keyword n has its name at 2n and its formID at 2n+1.
+		text::NameBlob keywordNameBlob;
+		/// @brief	Maps both the lowercase name and lowercase formID of each keyword to the KeywordIDs of every keyword that has it. Sorted & unique.
+		std::unordered_map<std::string, std::vector<KeywordID>> keywordLookup;
+		/// @brief	The effects that have each keyword, indexed by KeywordID. Sorted & unique.
+		std::vector<std::vector<EffectID>> keywordEffects;
+
+		EffectID intern_effect(const std::string& name)
+		{
+			auto name_lc{ str::tolower(name) };
+			if (const auto it{ effectLookup.find(name_lc) }; it != effectLookup.end())
+				return it->second;
+			const auto id{ $c(EffectID, effectNames.size()) };
+			effectLookup.emplace(name_lc, id);
+			effectNames.emplace_back(std::move(name_lc));
+			effectPostings.emplace_back();
+			return id;
+		}
+		KeywordID intern_keyword(const Keyword& keyword)
+		{
+			const auto formID_lc{ str::tolower(keyword.formID) }, name_lc{ str::tolower(keyword.name) };
+			// keywords without a formID fall back to their name
+			const auto& key{ formID_lc.empty() ? name_lc : formID_lc };
+			// several keywords can share a name, so only a keyword identified by the same key is the same keyword
+			auto& matches{ keywordLookup[key] };
+			if (const auto it{ std::find_if(matches.begin(), matches.end(), [&](const KeywordID id) {
+				const auto& other{ keywords[id] };
+				return str::tolower(other.formID.empty() ? other.name : other.formID) == key;
+			}) }; it != matches.end())
+				return *it;
+			const auto id{ $c(KeywordID, keywords.size()) };
+			matches.emplace_back(id);
+			if (!name_lc.empty() && name_lc != key) keywordLookup[name_lc].emplace_back(id);
+			keywords.emplace_back(keyword);
+			keywordEffects.emplace_back();
+			return id;
+		}
+
+		static std::span<const RangePosting> get_range(const std::vector<RangePosting>& column, const StatRange& range)
+		{
+			const auto first{ std::lower_bound(column.begin(), column.end(), range.min, [](auto&& posting, auto&& value) { return posting.value < value; }) };
+			const auto last{ std::upper_bound(first, column.end(), range.max, [](auto&& value, auto&& posting) { return value < posting.value; }) };
+			if (first >= last) return{};
+			return{ &*first, $c(size_t, std::distance(first, last)) };
+		}
+
+	public:
+		RegistryIndex(const Registry& registry) : registry{ &registry }
+		{
+			ingredientEffectOffsets.reserve(registry.size() + 1);
+			ingredientEffectOffsets.emplace_back(0u);
+			ingredientEffects.reserve(registry.size() * 4);
+			ingredientMagnitudes.reserve(registry.size() * 4);
+			ingredientDurations.reserve(registry.size() * 4);
+
+			for (IngredientID i{ 0 }; i < registry.size(); ++i) {
+				const auto& ingredient{ registry.Ingredients[i] };
+				ingredientNames.push_back(ingredient.name);
+				if (ingredient.effects.size() > std::numeric_limits<std::uint8_t>::max())
+					throw make_exception("Ingredient '", ingredient.name, "' has too many effects to be indexed!");
+
+				for (std::uint8_t slot{ 0 }; slot < ingredient.effects.size(); ++slot) {
+					const auto& effect{ ingredient.effects[slot] };
+					const auto effectID{ intern_effect(effect.name) };
+					ingredientEffects.emplace_back(effectID);
+					ingredientMagnitudes.emplace_back(effect.magnitude);
+					ingredientDurations.emplace_back(effect.duration);
+					effectPostings[effectID].emplace_back(EffectPosting{ i, slot });
+
+					for (const auto& keyword : effect.keywords)
+						keywordEffects[intern_keyword(keyword)].emplace_back(effectID);
+				}
+				ingredientEffectOffsets.emplace_back($c(std::uint32_t, ingredientEffects.size()));
+			}
+
+			for (const auto& name : effectNames)
+				effectNameBlob.push_back(name);
+			for (const auto& keyword : keywords) {
+				keywordNameBlob.push_back(keyword.name);
+				keywordNameBlob.push_back(keyword.formID);
+			}
+
+			effectTraits.reserve(effectNames.size());
+			effectBaseCosts.reserve(effectNames.size());
+			for (EffectID id{ 0 }; id < effectNames.size(); ++id) {
+				const auto& effect{ GetEffect(id) };
+				effectTraits.emplace_back(get_effect_traits(effect));
+				effectBaseCosts.emplace_back(effect.baseCost);
+			}
+
+			magnitudeColumns.resize(effectNames.size());
+			durationColumns.resize(effectNames.size());
+			for (EffectID id{ 0 }; id < effectNames.size(); ++id) {
+				const auto& postings{ effectPostings[id] };
+				auto& magnitudes{ magnitudeColumns[id] };
+				auto& durations{ durationColumns[id] };
+				magnitudes.reserve(postings.size());
+				durations.reserve(postings.size());
+				for (const auto& [ingredient, slot] : postings) {
+					const auto& offset{ ingredientEffectOffsets[ingredient] + slot };
+					magnitudes.emplace_back(RangePosting{ ingredientMagnitudes[offset], ingredient, slot });
+					durations.emplace_back(RangePosting{ $c(float, ingredientDurations[offset]), ingredient, slot });
+				}
+				constexpr auto by_value{ [](auto&& l, auto&& r) { return l.value < r.value; } };
+				std::stable_sort(magnitudes.begin(), magnitudes.end(), by_value);
+				std::stable_sort(durations.begin(), durations.end(), by_value);
+			}
+
+			for (auto& effectIDs : keywordEffects) {
+				std::sort(effectIDs.begin(), effectIDs.end());
+				effectIDs.erase(std::unique(effectIDs.begin(), effectIDs.end()), effectIDs.end());
+			}
+		}
+
+		/// @brief	Gets the registry that this index was built from.
+		CONSTEXPR const Registry& GetRegistry() const noexcept { return *registry; }
+		/// @brief	Gets the ingredient with the specified ID.
+		CONSTEXPR const Ingredient& GetIngredient(const IngredientID id) const { return registry->Ingredients[id]; }
+
+		/// @brief	Gets the names of all ingredients, indexed by IngredientID.
+		CONSTEXPR const text::NameBlob& GetIngredientNames() const noexcept { return ingredientNames; }
+
+		/**
+		 * @brief					Gets all ingredients whose names match the given search term, using a single pass over every ingredient name.
+		 * @param name				The name to search for. This is not case-sensitive.
+		 * @param requireExactMatch	When true, only ingredient names that are equal to name are matched; otherwise any ingredient name that contains name is matched.
+		 * @returns					A ResultSet over the source registry.
+		 */
+		ResultSet FindIngredients(const std::string& name, const bool requireExactMatch) const
+		{
+			return{ registry->Ingredients, ingredientNames.find_names(name, requireExactMatch) };
+		}
+
+	#pragma region Effects
+		CONSTEXPR size_t GetEffectCount() const noexcept { return effectNames.size(); }
+		/// @brief	Gets the lowercase name of the specified effect.
+		CONSTEXPR const std::string& GetEffectName(const EffectID id) const { return effectNames[id]; }
+		/// @brief	Gets the keyword-derived traits of the specified effect.
+		CONSTEXPR const EffectTraits& GetTraits(const EffectID id) const { return effectTraits[id]; }
+		/// @brief	Gets the base cost of the specified effect, which is used to calculate potion values.
+		CONSTEXPR float GetBaseCost(const EffectID id) const { return effectBaseCosts[id]; }
+		/// @brief	Gets the base costs of all effects, indexed by EffectID.
+		CONSTEXPR std::span<const float> GetBaseCosts() const noexcept { return effectBaseCosts; }
+		/// @brief	Gets the first occurrence of the specified effect, which has its original name & keywords.
+		CONSTEXPR const Effect& GetEffect(const EffectID id) const
+		{
+			const auto& posting{ effectPostings[id].front() };
+			return registry->Ingredients[posting.ingredient].effects[posting.slot];
+		}
+		/// @brief	Gets the lowercase names of all effects, indexed by EffectID.
+		CONSTEXPR const text::NameBlob& GetEffectNames() const noexcept { return effectNameBlob; }
+
+		/**
+		 * @brief		Gets the ID of the effect with the specified name.
+		 * @param name	The name of the effect. This is not case-sensitive.
+		 * @returns		The EffectID of the effect when it exists in the registry; otherwise std::nullopt.
+		 */
+		std::optional<EffectID> FindEffect(const std::string& name) const
+		{
+			if (const auto it{ effectLookup.find(str::tolower(name)) }; it != effectLookup.end())
+				return it->second;
+			return std::nullopt;
+		}
+		/**
+		 * @brief					Gets the IDs of all effects whose names match the given search term.
+		 * @param name				The name to search for. This is not case-sensitive.
+		 * @param requireExactMatch	When true, only effect names that are equal to name are matched; otherwise any effect name that contains name is matched.
+		 * @returns					A sorted vector of EffectIDs.
+		 */
+		std::vector<EffectID> FindEffects(const std::string& name, const bool requireExactMatch) const
+		{
+			if (requireExactMatch) {
+				if (const auto id{ FindEffect(name) }; id.has_value())
+					return{ id.value() };
+				return{};
+			}
+			return effectNameBlob.find_names(name, false);
+		}
+
+		/// @brief	Gets the occurrences of the specified effect, sorted by ingredient.
+		CONSTEXPR const std::vector<EffectPosting>& GetPostings(const EffectID id) const { return effectPostings[id]; }
+		/// @brief	Gets the EffectIDs of the specified ingredient's effects, in the same order as Ingredient::effects.
+		CONSTEXPR std::span<const EffectID> GetEffectIDs(const IngredientID id) const
+		{
+			return{ ingredientEffects.data() + ingredientEffectOffsets[id], ingredientEffects.data() + ingredientEffectOffsets[id + 1] };
+		}
+		/// @brief	Gets the magnitudes of the specified ingredient's effects, in the same order as Ingredient::effects.
+		CONSTEXPR std::span<const float> GetMagnitudes(const IngredientID id) const
+		{
+			return{ ingredientMagnitudes.data() + ingredientEffectOffsets[id], ingredientMagnitudes.data() + ingredientEffectOffsets[id + 1] };
+		}
+		/// @brief	Gets the durations of the specified ingredient's effects, in the same order as Ingredient::effects.
+		CONSTEXPR std::span<const unsigned> GetDurations(const IngredientID id) const
+		{
+			return{ ingredientDurations.data() + ingredientEffectOffsets[id], ingredientDurations.data() + ingredientEffectOffsets[id + 1] };
+		}
+	#pragma endregion Effects
+
+	#pragma region Ranges
+		/**
+		 * @brief			Gets the occurrences of the specified effect with a magnitude within the given range, using binary search.
+		 * @param id		The effect to search.
+		 * @param range		The inclusive range of magnitudes to include.
+		 * @returns			The matching occurrences, sorted by magnitude.
+		 */
+		std::span<const RangePosting> GetMagnitudeRange(const EffectID id, const StatRange& range) const
+		{
+			return get_range(magnitudeColumns[id], range);
+		}
+		/**
+		 * @brief			Gets the occurrences of the specified effect with a duration within the given range, using binary search.
+		 * @param id		The effect to search.
+		 * @param range		The inclusive range of durations to include.
+		 * @returns			The matching occurrences, sorted by duration.
+		 */
+		std::span<const RangePosting> GetDurationRange(const EffectID id, const StatRange& range) const
+		{
+			return get_range(durationColumns[id], range);
+		}
+
+		/**
+		 * @brief					Gets all ingredients that have one of the specified effects with a magnitude & duration within the given ranges.
+		 *							Both ranges must be satisfied by the same effect.
+		 * @param effectIDs			The effects to search.
+		 * @param magnitudeRange	The inclusive range of magnitudes to include.
+		 * @param durationRange		The inclusive range of durations to include.
+		 * @returns					A ResultSet over the source registry.
+		 */
+		ResultSet SelectInRange(std::span<const EffectID> effectIDs, const StatRange& magnitudeRange, const StatRange& durationRange = {}) const
+		{
+			ResultSet results{ registry->Ingredients };
+			for (const auto& effectID : effectIDs) {
+				if (!magnitudeRange.IsUnbounded()) {
+					for (const auto& posting : GetMagnitudeRange(effectID, magnitudeRange))
+						if (durationRange.IsUnbounded() || durationRange.Contains($c(float, ingredientDurations[ingredientEffectOffsets[posting.ingredient] + posting.slot])))
+							results.insert(posting.ingredient);
+				}
+				else {
+					for (const auto& posting : GetDurationRange(effectID, durationRange))
+						results.insert(posting.ingredient);
+				}
+			}
+			return results;
+		}
+		/// @brief	Gets all ingredients that have any effect with a magnitude & duration within the given ranges.
+		ResultSet SelectInRange(const StatRange& magnitudeRange, const StatRange& durationRange = {}) const
+		{
+			std::vector<EffectID> effectIDs(effectNames.size());
+			std::iota(effectIDs.begin(), effectIDs.end(), EffectID{ 0 });
+			return SelectInRange(effectIDs, magnitudeRange, durationRange);
+		}
+	#pragma endregion Ranges
+
+	#pragma region Keywords
+		CONSTEXPR size_t GetKeywordCount() const noexcept { return keywords.size(); }
+		CONSTEXPR const Keyword& GetKeyword(const KeywordID id) const { return keywords[id]; }
+
+		/**
+		 * @brief					Gets the IDs of all keywords whose name or formID match the given search term.
+		 * @param name_or_id		The name or formID to search for. This is not case-sensitive.
+		 * @param requireExactMatch	When true, only keywords with a name or formID equal to name_or_id are matched; otherwise any keyword whose name or formID contains name_or_id is matched.
+		 * @returns					A sorted vector of KeywordIDs.
+		 */
+		std::vector<KeywordID> FindKeywords(const std::string& name_or_id, const bool requireExactMatch) const
+		{
+			if (requireExactMatch) {
+				if (const auto it{ keywordLookup.find(str::tolower(name_or_id)) }; it != keywordLookup.end())
+					return it->second;
+				return{};
+			}
+			auto ids{ keywordNameBlob.find_names(name_or_id, false) };
+			for (auto& id : ids)
+				id /= 2;
+			ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+			return ids;
+		}
+
+		/// @brief	Gets the IDs of all effects that have the specified keyword.
+		CONSTEXPR const std::vector<EffectID>& GetEffectsWithKeyword(const KeywordID id) const { return keywordEffects[id]; }
+
+		/**
+		 * @brief					Gets the IDs of all effects that have a keyword matching the given search term.
+		 * @param name_or_id		The name or formID of the keyword to search for. This is not case-sensitive.
+		 * @param requireExactMatch	When true, keywords must match exactly; otherwise partial matches are allowed.
+		 * @returns					A sorted vector of unique EffectIDs.
+		 */
+		std::vector<EffectID> FindEffectsWithKeyword(const std::string& name_or_id, const bool requireExactMatch) const
+		{
+			std::vector<EffectID> ids;
+			for (const auto& keywordID : FindKeywords(name_or_id, requireExactMatch)) {
+				const auto& effectIDs{ keywordEffects[keywordID] };
+				ids.insert(ids.end(), effectIDs.begin(), effectIDs.end());
+			}
+			std::sort(ids.begin(), ids.end());
+			ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+			return ids;
+		}
+	#pragma endregion Keywords
+
+		/**
+		 * @brief			Gets all ingredients that have any of the specified effects.
+		 * @param effectIDs	The effects to search for.
+		 * @returns			A ResultSet over the source registry.
+		 */
+		ResultSet GetIngredientsWithAnyEffect(std::span<const EffectID> effectIDs) const
+		{
+			ResultSet results{ registry->Ingredients };
+			for (const auto& effectID : effectIDs)
+				for (const auto& posting : effectPostings[effectID])
+					results.insert(posting.ingredient);
+			return results;
+		}
+		/**
+		 * @brief					Gets all ingredients that have an effect with a keyword matching the given search term.
+		 * @param name_or_id		The name or formID of the keyword to search for. This is not case-sensitive.
+		 * @param requireExactMatch	When true, keywords must match exactly; otherwise partial matches are allowed.
+		 * @returns					A ResultSet over the source registry.
+		 */
+		ResultSet FindIngredientsWithKeyword(const std::string& name_or_id, const bool requireExactMatch) const
+		{
+			return GetIngredientsWithAnyEffect(FindEffectsWithKeyword(name_or_id, requireExactMatch));
+		}
+	};
+}
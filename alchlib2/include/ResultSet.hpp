@@ -0,0 +1,207 @@
+#pragma once
+#include "Ingredient.hpp"
+
+#include <make_exception.hpp>
+
+#include <bit>
+#include <cstdint>
+#include <iterator>
+#include <span>
+
+namespace alchlib2 {
+	/// @brief	Position of an ingredient in the Registry that it belongs to.
+	using IngredientID = std::uint32_t;
+
+	/**
+	 * @brief		A non-owning set of ingredients from a source ingredient list, stored as a bitset.
+	 *				Result sets can be combined with set operations, iterated as const Ingredient references,
+	 *				 and only copy ingredients when Materialize() is called.
+	 *				The source list must outlive the result set, and must not be modified while it is in use.
+	 */
+	class ResultSet {
+		using word_t = std::uint64_t;
+		static constexpr size_t WORD_BITS{ sizeof(word_t) * 8 };
+
+		const std::vector<Ingredient>* source;
+		std::vector<word_t> words;
+
+		CONSTEXPR void throwIfSourceMismatch(const ResultSet& o) const
+		{
+			if (source != o.source)
+				throw make_exception("Cannot combine result sets that were created from different ingredient lists!");
+		}
+		/// @brief	Clears any bits past the end of the source list, which can be set by the complement operator.
+		CONSTEXPR void trim() noexcept
+		{
+			if (const auto rem{ source->size() % WORD_BITS }; rem != 0 && !words.empty())
+				words.back() &= (word_t{ 1 } << rem) - 1;
+		}
+
+	public:
+		/**
+		 * @brief			Creates a new result set for the given source list.
+		 * @param source	The ingredient list that this result set refers to.
+		 * @param fill		When true, the result set contains every ingredient in source; otherwise it is empty.
+		 */
+		ResultSet(const std::vector<Ingredient>& source, const bool fill = false) : source{ &source }, words((source.size() + WORD_BITS - 1) / WORD_BITS, fill ? ~word_t{ 0 } : word_t{ 0 })
+		{
+			if (fill) trim();
+		}
+		/**
+		 * @brief			Creates a new result set containing the specified ingredients.
+		 * @param source	The ingredient list that this result set refers to.
+		 * @param ids		The positions of the ingredients to include.
+		 */
+		ResultSet(const std::vector<Ingredient>& source, std::span<const IngredientID> ids) : ResultSet(source)
+		{
+			for (const auto& id : ids)
+				insert(id);
+		}
+
+		class const_iterator {
+			const ResultSet* set;
+			size_t pos;
+
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = Ingredient;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const Ingredient*;
+			using reference = const Ingredient&;
+
+			CONSTEXPR const_iterator() : set{ nullptr }, pos{ 0 } {}
+			CONSTEXPR const_iterator(const ResultSet* set, const size_t pos) : set{ set }, pos{ set->find_next(pos) } {}
+
+			/// @brief	Gets the position of the current ingredient in the source list.
+			CONSTEXPR IngredientID id() const noexcept { return $c(IngredientID, pos); }
+
+			CONSTEXPR reference operator*() const { return (*set->source)[pos]; }
+			CONSTEXPR pointer operator->() const { return &(*set->source)[pos]; }
+
+			CONSTEXPR const_iterator& operator++()
+			{
+				pos = set->find_next(pos + 1);
+				return *this;
+			}
+			CONSTEXPR const_iterator operator++(int)
+			{
+				auto copy{ *this };
+				++(*this);
+				return copy;
+			}
+
+			friend CONSTEXPR bool operator==(const const_iterator& l, const const_iterator& r) noexcept { return l.pos == r.pos; }
+			friend CONSTEXPR bool operator!=(const const_iterator& l, const const_iterator& r) noexcept { return l.pos != r.pos; }
+		};
+		using iterator = const_iterator;
+
+		/// @brief	Gets the position of the first ingredient at or after pos that is in the set, or the size of the source list.
+		CONSTEXPR size_t find_next(size_t pos) const noexcept
+		{
+			const auto end{ source->size() };
+			if (pos >= end) return end;
+			auto wordIndex{ pos / WORD_BITS };
+			auto word{ words[wordIndex] & (~word_t{ 0 } << (pos % WORD_BITS)) };
+			while (word == 0) {
+				if (++wordIndex == words.size()) return end;
+				word = words[wordIndex];
+			}
+			return wordIndex * WORD_BITS + $c(size_t, std::countr_zero(word));
+		}
+
+	#pragma region VectorInterface
+		CONSTEXPR const_iterator begin() const { return{ this, 0 }; }
+		CONSTEXPR const_iterator end() const { return{ this, source->size() }; }
+		CONSTEXPR bool empty() const noexcept
+		{
+			return std::all_of(words.begin(), words.end(), [](auto&& word) { return word == 0; });
+		}
+		CONSTEXPR size_t size() const noexcept
+		{
+			size_t count{ 0 };
+			for (const auto& word : words)
+				count += $c(size_t, std::popcount(word));
+			return count;
+		}
+	#pragma endregion VectorInterface
+
+		/// @brief	Gets the ingredient list that this result set refers to.
+		CONSTEXPR const std::vector<Ingredient>& GetSource() const noexcept { return *source; }
+
+		CONSTEXPR bool contains(const IngredientID id) const noexcept
+		{
+			return id < source->size() && (words[id / WORD_BITS] >> (id % WORD_BITS)) & 1;
+		}
+		CONSTEXPR void insert(const IngredientID id)
+		{
+			if (id >= source->size()) throw make_exception("Ingredient ID ", id, " is out of range!");
+			words[id / WORD_BITS] |= word_t{ 1 } << (id % WORD_BITS);
+		}
+		CONSTEXPR void erase(const IngredientID id) noexcept
+		{
+			if (id < source->size())
+				words[id / WORD_BITS] &= ~(word_t{ 1 } << (id % WORD_BITS));
+		}
+
+		/// @brief	Gets the positions of all ingredients in the set, in ascending order.
+		std::vector<IngredientID> GetIDs() const
+		{
+			std::vector<IngredientID> ids;
+			ids.reserve(size());
+			for (auto it{ begin() }, end{ this->end() }; it != end; ++it)
+				ids.emplace_back(it.id());
+			return ids;
+		}
+
+		/// @brief	Copies all of the ingredients in the set into a new list.
+		std::vector<Ingredient> Materialize() const
+		{
+			std::vector<Ingredient> vec;
+			vec.reserve(size());
+			std::copy(begin(), end(), std::back_inserter(vec));
+			return vec;
+		}
+
+	#pragma region Operators
+		/// @brief	Intersection
+		CONSTEXPR ResultSet& operator&=(const ResultSet& o)
+		{
+			throwIfSourceMismatch(o);
+			for (size_t i{ 0 }; i < words.size(); ++i)
+				words[i] &= o.words[i];
+			return *this;
+		}
+		/// @brief	Union
+		CONSTEXPR ResultSet& operator|=(const ResultSet& o)
+		{
+			throwIfSourceMismatch(o);
+			for (size_t i{ 0 }; i < words.size(); ++i)
+				words[i] |= o.words[i];
+			return *this;
+		}
+		/// @brief	Difference
+		CONSTEXPR ResultSet& operator-=(const ResultSet& o)
+		{
+			throwIfSourceMismatch(o);
+			for (size_t i{ 0 }; i < words.size(); ++i)
+				words[i] &= ~o.words[i];
+			return *this;
+		}
+		/// @brief	Complement; gets every ingredient in the source list that isn't in this set.
+		[[nodiscard]] CONSTEXPR ResultSet operator~() const
+		{
+			ResultSet copy{ *this };
+			for (auto& word : copy.words)
+				word = ~word;
+			copy.trim();
+			return copy;
+		}
+
+		friend CONSTEXPR ResultSet operator&(ResultSet l, const ResultSet& r) { return l &= r; }
+		friend CONSTEXPR ResultSet operator|(ResultSet l, const ResultSet& r) { return l |= r; }
+		friend CONSTEXPR ResultSet operator-(ResultSet l, const ResultSet& r) { return l -= r; }
+
+		friend CONSTEXPR bool operator==(const ResultSet& l, const ResultSet& r) noexcept { return l.source == r.source && l.words == r.words; }
+	#pragma endregion Operators
+	};
+}
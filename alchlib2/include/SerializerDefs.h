@@ -27,7 +27,29 @@ namespace alchlib2 {
 								 { Negative, "Negative" },
 								 { InfluenceOther, "InfluenceOther" }
 								 });*/
-	NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(Effect, name, magnitude, duration, keywords);
-	NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(Ingredient, name, effects);
+	// baseCost, value & weight were added later, so they're optional to keep older registry files readable; every other field is still required
+	inline void to_json(nlohmann::json& j, Effect const& effect)
+	{
+		j = nlohmann::json{ { "name", effect.name }, { "magnitude", effect.magnitude }, { "duration", effect.duration }, { "keywords", effect.keywords }, { "baseCost", effect.baseCost } };
+	}
+	inline void from_json(nlohmann::json const& j, Effect& effect)
+	{
+		j.at("name").get_to(effect.name);
+		j.at("magnitude").get_to(effect.magnitude);
+		j.at("duration").get_to(effect.duration);
+		j.at("keywords").get_to(effect.keywords);
+		effect.baseCost = j.value("baseCost", effect.baseCost);
+	}
+	inline void to_json(nlohmann::json& j, Ingredient const& ingredient)
+	{
+		j = nlohmann::json{ { "name", ingredient.name }, { "effects", ingredient.effects }, { "value", ingredient.value }, { "weight", ingredient.weight } };
+	}
+	inline void from_json(nlohmann::json const& j, Ingredient& ingredient)
+	{
+		j.at("name").get_to(ingredient.name);
+		j.at("effects").get_to(ingredient.effects);
+		ingredient.value = j.value("value", ingredient.value);
+		ingredient.weight = j.value("weight", ingredient.weight);
+	}
 	NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(Potion, name, effects);
 }
@@ -0,0 +1,225 @@
+#pragma once
+#include "PotionCache.hpp"
+#include "RecipeEnumerator.hpp"
+
+#include <make_exception.hpp>
+#include <fileio.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <optional>
+#include <unordered_map>
+
+namespace alchlib2 {
+	/// @brief	The set of effects that a potion has, as EffectIDs in ascending order.
+	class EffectSignature {
+		std::array<EffectID, MAX_COMMON_EFFECTS> effectIDs{};
+		std::uint8_t count{ 0 };
+
+	public:
+		CONSTEXPR EffectSignature() = default;
+		/**
+		 * @brief			Creates the signature of a set of effects.
+		 * @param ids		The EffectIDs of the effects, in any order. Duplicates are ignored.
+		 */
+		EffectSignature(std::span<const EffectID> ids)
+		{
+			for (const auto& id : ids) {
+				if (std::find(effectIDs.begin(), effectIDs.begin() + count, id) != effectIDs.begin() + count)
+					continue;
+				if (count == effectIDs.size())
+					throw make_exception("Potions can't have more than ", MAX_COMMON_EFFECTS, " effects!");
+				effectIDs[count++] = id;
+			}
+			std::sort(effectIDs.begin(), effectIDs.begin() + count);
+		}
+
+		CONSTEXPR size_t size() const noexcept { return count; }
+		CONSTEXPR bool empty() const noexcept { return count == 0; }
+		CONSTEXPR std::span<const EffectID> GetEffectIDs() const noexcept { return{ effectIDs.data(), count }; }
+		/// @brief	Checks if the signature includes an effect.
+		CONSTEXPR bool Contains(const EffectID id) const noexcept { return std::binary_search(effectIDs.begin(), effectIDs.begin() + count, id); }
+
+		CONSTEXPR bool operator==(EffectSignature const&) const noexcept = default;
+
+		/// @brief	Hashes a signature for use as an unordered_map key.
+		struct Hash {
+			size_t operator()(EffectSignature const& signature) const noexcept
+			{
+				return $c(size_t, Fingerprint{}.add(signature.GetEffectIDs()).get());
+			}
+		};
+	};
+
+	/**
+	 * @brief		An index of every useful recipe in a registry by the set of effects that it produces, so that every recipe for
+	 *				 a potion can be found with a single hash lookup instead of enumerating the registry.
+	 *				Signatures are the common effects of the ingredients, which don't depend on game settings. The Purity perk can
+	 *				 remove effects from a potion, so a potion made with it might have a smaller signature than its recipe.
+	 *				Like CompatibilityMatrix, the index must be rebuilt whenever the registry is modified. It can be saved to disk &
+	 *				 read back in later sessions; saved indexes are discarded if the registry changed.
+	 *				Unlike RecipeDatabase::Update, a saved index is never updated incrementally when the registry changes; the whole
+	 *				 index is built again. Reading & writing the JSON file costs more than enumerating every recipe, so carrying
+	 *				 recipes over from a stale file wouldn't make rebuilding it any faster.
+	 */
+	class SignatureIndex {
+		size_t maxIngredients;
+		/// @brief	Every signature, in the order that their first recipe was enumerated.
+		std::vector<EffectSignature> signatures;
+		/// @brief	The recipes of signature s are in [offsets[s], offsets[s + 1]).
+		std::vector<std::uint32_t> offsets;
+		/// @brief	Grouped by signature, in lexicographic order within each group.
+		std::vector<Recipe> recipes;
+		std::unordered_map<EffectSignature, std::uint32_t, EffectSignature::Hash> lookup;
+
+		SignatureIndex(const size_t maxIngredients) : maxIngredients{ maxIngredients } {}
+
+		/// @brief	Gets the signature of a recipe.
+		static EffectSignature get_signature(RegistryIndex const& index, Recipe const& recipe)
+		{
+			const auto& ingredients{ recipe.GetIngredients() };
+			std::array<EffectID, MAX_COMMON_EFFECTS> ids;
+			size_t count{ 0 };
+			for (const auto& effect : get_common_effects(index, ingredients))
+				ids[count++] = index.GetEffectIDs(ingredients[effect.ingredient])[effect.slot];
+			return EffectSignature{ std::span<const EffectID>{ ids.data(), count } };
+		}
+
+		/// @brief	Adds a signature with no recipes & returns its position.
+		std::uint32_t add_signature(EffectSignature const& signature)
+		{
+			const auto& [it, added] { lookup.emplace(signature, $c(std::uint32_t, signatures.size())) };
+			if (added)
+				signatures.emplace_back(signature);
+			return it->second;
+		}
+
+	public:
+		/**
+		 * @brief					Builds the index by enumerating every useful recipe in a registry.
+		 * @param matrix			The compatibility matrix of the registry.
+		 * @param maxIngredients	The maximum number of ingredients per recipe, from 2 to MAX_POTION_INGREDIENTS.
+		 */
+		SignatureIndex(CompatibilityMatrix const& matrix, const size_t maxIngredients = 3) : maxIngredients{ maxIngredients }
+		{
+			const auto& index{ matrix.GetIndex() };
+			const RecipeEnumerator enumerator{ matrix, 2, maxIngredients };
+
+			// enumerate once, remembering each recipe's signature, then group the recipes with a counting sort
+			std::vector<Recipe> enumerated;
+			std::vector<std::uint32_t> positions;
+			enumerator.ForEachRecipe([&](Recipe const& recipe) {
+				positions.emplace_back(add_signature(get_signature(index, recipe)));
+				enumerated.emplace_back(recipe);
+			});
+
+			offsets.assign(signatures.size() + 1, 0u);
+			for (const auto& s : positions)
+				++offsets[s + 1];
+			for (size_t s{ 0 }; s < signatures.size(); ++s)
+				offsets[s + 1] += offsets[s];
+			recipes.resize(enumerated.size());
+			auto next{ offsets };
+			for (size_t r{ 0 }; r < enumerated.size(); ++r)
+				recipes[next[positions[r]]++] = enumerated[r];
+		}
+
+		/**
+		 * @brief					Reads an index that was saved by WriteTo.
+		 * @param path				The path of the file.
+		 * @param index				The index of the registry that recipes refer to.
+		 * @param maxIngredients	The maximum number of ingredients per recipe that the index must have been built with.
+		 * @returns					The index, or std::nullopt when the file doesn't exist, or was saved with a different registry
+		 *							 or maximum number of ingredients, in which case the index has to be built from scratch.
+		 */
+		[[nodiscard]] static std::optional<SignatureIndex> ReadFrom(std::filesystem::path const& path, RegistryIndex const& index, const size_t maxIngredients = 3)
+		{
+			if (!file::exists(path))
+				return std::nullopt;
+
+			nlohmann::json j;
+			file::read(path) >> j;
+			if (!j.is_object() || !j.contains("registry") || !j.contains("maxIngredients") || !j.contains("signatures"))
+				throw make_exception("Signature index file ", path, " is invalid!");
+			if (j["registry"].get<std::uint64_t>() != get_registry_fingerprint(index) || j["maxIngredients"].get<size_t>() != maxIngredients)
+				return std::nullopt;
+
+			SignatureIndex signatureIndex{ maxIngredients };
+			signatureIndex.offsets.emplace_back(0u);
+			for (const auto& group : j["signatures"]) {
+				const auto& effects{ group["effects"].get<std::vector<EffectID>>() };
+				for (const auto& id : effects)
+					if (id >= index.GetEffectCount())
+						throw make_exception("Signature index file ", path, " contains an invalid effect ID!");
+				if (signatureIndex.add_signature(EffectSignature{ effects }) != signatureIndex.offsets.size() - 1)
+					throw make_exception("Signature index file ", path, " contains the same signature more than once!");
+
+				for (const auto& ingredients : group["recipes"]) {
+					if (ingredients.size() < 2 || ingredients.size() > maxIngredients)
+						throw make_exception("Signature index file ", path, " contains an invalid recipe!");
+					Recipe recipe;
+					for (const auto& id : ingredients) {
+						if (id.get<IngredientID>() >= index.GetRegistry().size())
+							throw make_exception("Signature index file ", path, " contains an invalid ingredient ID!");
+						recipe.ingredients[recipe.count++] = id.get<IngredientID>();
+					}
+					signatureIndex.recipes.emplace_back(recipe);
+				}
+				signatureIndex.offsets.emplace_back($c(std::uint32_t, signatureIndex.recipes.size()));
+			}
+			return signatureIndex;
+		}
+		/**
+		 * @brief					Saves an index, so that it can be read by ReadFrom in a later session.
+		 * @param path				The path of the file.
+		 * @param index				The index of the registry that recipes refer to.
+		 * @param signatureIndex	The index to save.
+		 * @returns					True when the file was written successfully.
+		 */
+		static bool WriteTo(std::filesystem::path const& path, RegistryIndex const& index, SignatureIndex const& signatureIndex)
+		{
+			nlohmann::json signatures = nlohmann::json::array();
+			for (size_t s{ 0 }; s < signatureIndex.size(); ++s) {
+				const auto& effects{ signatureIndex.signatures[s].GetEffectIDs() };
+				nlohmann::json recipes = nlohmann::json::array();
+				for (const auto& recipe : signatureIndex.GetRecipes(s)) {
+					const auto& ingredients{ recipe.GetIngredients() };
+					recipes.push_back(std::vector<IngredientID>{ ingredients.begin(), ingredients.end() });
+				}
+				signatures.push_back({
+					{ "effects", std::vector<EffectID>{ effects.begin(), effects.end() } },
+					{ "recipes", std::move(recipes) },
+				});
+			}
+			return file::write(path, nlohmann::json{
+				{ "registry", get_registry_fingerprint(index) },
+				{ "maxIngredients", signatureIndex.maxIngredients },
+				{ "signatures", std::move(signatures) },
+			});
+		}
+
+		/// @brief	Gets the number of distinct signatures.
+		CONSTEXPR size_t size() const noexcept { return signatures.size(); }
+		CONSTEXPR size_t GetMaxIngredients() const noexcept { return maxIngredients; }
+		/// @brief	Gets the total number of recipes of every signature.
+		CONSTEXPR size_t GetRecipeCount() const noexcept { return recipes.size(); }
+		/// @brief	Gets every signature, in the order that their first recipe was enumerated.
+		CONSTEXPR std::span<const EffectSignature> GetSignatures() const noexcept { return signatures; }
+		/// @brief	Gets the recipes of the signature at position s in GetSignatures(), in lexicographic order.
+		CONSTEXPR std::span<const Recipe> GetRecipes(const size_t s) const noexcept { return{ recipes.data() + offsets[s], recipes.data() + offsets[s + 1] }; }
+
+		/**
+		 * @brief			Finds every recipe that produces exactly a set of effects.
+		 * @param signature	The effects.
+		 * @returns			The recipes in lexicographic order, or an empty span if no recipe produces exactly those effects.
+		 */
+		std::span<const Recipe> Find(EffectSignature const& signature) const noexcept
+		{
+			if (const auto& it{ lookup.find(signature) }; it != lookup.end())
+				return GetRecipes(it->second);
+			return{};
+		}
+	};
+}
@@ -0,0 +1,229 @@
+#pragma once
+#include <sysarch.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace alchlib2::text {
+	/// @brief	The instruction sets that the search kernels can use.
+	enum class InstructionSet : std::uint8_t {
+		Scalar,
+		SSE2,
+		AVX2,
+	};
+
+	/// @brief	Gets the fastest instruction set supported by the current CPU. This is detected once & cached.
+	InstructionSet GetInstructionSet() noexcept;
+	/// @brief	Forces the search kernels to use the specified instruction set, or the fastest supported one if it isn't supported.
+	void SetInstructionSet(InstructionSet const& instructionSet) noexcept;
+
+	/// @brief	ASCII-only lowercase conversion for a single character.
+	inline constexpr char tolower(const char c) noexcept
+	{
+		return (c >= 'A' && c <= 'Z') ? $c(char, c + ('a' - 'A')) : c;
+	}
+	/// @brief	ASCII-only lowercase conversion for a string.
+	inline std::string tolower(std::string_view s)
+	{
+		std::string result(s.size(), '\0');
+		for (size_t i{ 0 }; i < s.size(); ++i)
+			result[i] = tolower(s[i]);
+		return result;
+	}
+	/// @brief	Case-insensitive (ASCII) string equality.
+	inline constexpr bool equals(std::string_view l, std::string_view r) noexcept
+	{
+		if (l.size() != r.size()) return false;
+		for (size_t i{ 0 }; i < l.size(); ++i)
+			if (tolower(l[i]) != tolower(r[i]))
+				return false;
+		return true;
+	}
+
+	/**
+	 * @brief				Finds all case-insensitive (ASCII) occurrences of a substring, using the fastest available instruction set.
+	 * @param haystack		The text to search.
+	 * @param needle_lc		The substring to search for. This must already be lowercase.
+	 * @param offsets		Receives the offset of each occurrence, in ascending order. Overlapping occurrences are included.
+	 */
+	void find_all(std::string_view haystack, std::string_view needle_lc, std::vector<size_t>& offsets);
+	/**
+	 * @brief				Finds the first case-insensitive (ASCII) occurrence of a substring, using the fastest available instruction set.
+	 * @param haystack		The text to search.
+	 * @param needle_lc		The substring to search for. This must already be lowercase.
+	 * @returns				The offset of the first occurrence when found; otherwise std::string_view::npos.
+	 */
+	size_t find_first(std::string_view haystack, std::string_view needle_lc) noexcept;
+
+	/// @brief	Case-insensitive (ASCII) substring search that doesn't require needle to be lowercase.
+	inline size_t find(std::string_view haystack, std::string_view needle)
+	{
+		return find_first(haystack, tolower(needle));
+	}
+	/// @brief	Checks if haystack contains needle, ignoring case (ASCII).
+	inline bool contains(std::string_view haystack, std::string_view needle)
+	{
+		return find(haystack, needle) != std::string_view::npos;
+	}
+
+	/**
+	 * @brief		An Aho-Corasick automaton that finds case-insensitive (ASCII) occurrences of any number
+	 *				 of search terms in a single pass over the text, regardless of how many terms there are.
+	 *				Empty search terms are never matched by scan().
+	 */
+	class MultiPattern {
+		/// @brief	The lowercase search terms.
+		std::vector<std::string> terms;
+		/// @brief	Maps each byte to its equivalence class. Bytes that don't appear in any term are class 0.
+		std::array<std::uint8_t, 256> classes{};
+		size_t classCount{ 1 };
+		/// @brief	The full transition table, indexed by (state * classCount + class).
+		std::vector<std::uint32_t> transitions;
+		/// @brief	The terms that end at each state, indexed by outputOffsets.
+		std::vector<std::uint32_t> outputs;
+		std::vector<std::uint32_t> outputOffsets;
+
+	public:
+		/**
+		 * @brief			Builds an automaton for the given search terms.
+		 * @param terms		The search terms. These are not case-sensitive. Terms are referred to by their position in this list.
+		 */
+		MultiPattern(std::vector<std::string> const& terms);
+
+		/// @brief	Gets the number of search terms.
+		CONSTEXPR size_t size() const noexcept { return terms.size(); }
+		/// @brief	Gets the lowercase search term at the specified position.
+		CONSTEXPR const std::string& term(const size_t index) const { return terms[index]; }
+
+		/**
+		 * @brief			Finds every occurrence of every search term in the given text.
+		 * @param text		The text to search.
+		 * @param onMatch	A callable with the signature void(std::uint32_t term, size_t offset) that is called for each occurrence, in the order that they end.
+		 */
+		template<typename TOnMatch>
+		void scan(std::string_view text, TOnMatch&& onMatch) const
+		{
+			std::uint32_t state{ 0 };
+			for (size_t i{ 0 }; i < text.size(); ++i) {
+				state = transitions[state * classCount + classes[$c(std::uint8_t, text[i])]];
+				for (auto o{ outputOffsets[state] }, end{ outputOffsets[state + 1] }; o < end; ++o)
+					onMatch(outputs[o], i + 1 - terms[outputs[o]].size());
+			}
+		}
+	};
+
+	/**
+	 * @brief		A list of names stored in one contiguous, null-separated buffer so that substring searches
+	 *				 over every name run as a single pass of the search kernel.
+	 */
+	class NameBlob {
+		std::string blob;
+		/// @brief	The starting offset of each name in the blob, followed by the size of the blob.
+		std::vector<std::uint32_t> offsets{ 0u };
+
+	public:
+		/// @brief	A single occurrence of a search term in a name.
+		struct Match {
+			/// @brief	The position of the name in the blob.
+			std::uint32_t index;
+			/// @brief	The offset of the occurrence from the start of the name.
+			std::uint32_t offset;
+		};
+
+		NameBlob() = default;
+		template<typename TRange, typename TProjection>
+		NameBlob(TRange const& range, TProjection const& projection)
+		{
+			for (const auto& it : range)
+				push_back(projection(it));
+		}
+
+		void push_back(std::string_view name)
+		{
+			blob.append(name);
+			blob.push_back('\0');
+			offsets.emplace_back($c(std::uint32_t, blob.size()));
+		}
+
+		CONSTEXPR size_t size() const noexcept { return offsets.size() - 1; }
+		CONSTEXPR bool empty() const noexcept { return size() == 0; }
+		CONSTEXPR std::string_view at(const size_t index) const { return std::string_view{ blob }.substr(offsets[index], offsets[index + 1] - offsets[index] - 1); }
+		CONSTEXPR std::string_view operator[](const size_t index) const { return at(index); }
+
+		/**
+		 * @brief				Finds every occurrence of the given search term in every name.
+		 * @param needle		The substring to search for. This is not case-sensitive.
+		 * @returns				Each occurrence, sorted by name & offset.
+		 */
+		std::vector<Match> find_all(std::string_view needle) const
+		{
+			std::vector<Match> matches;
+			if (needle.empty()) return matches;
+			std::vector<size_t> positions;
+			text::find_all(blob, tolower(needle), positions);
+			matches.reserve(positions.size());
+			std::uint32_t index{ 0 };
+			for (const auto& pos : positions) {
+				while (offsets[index + 1] <= pos) ++index;
+				matches.emplace_back(Match{ index, $c(std::uint32_t, pos - offsets[index]) });
+			}
+			return matches;
+		}
+		/// @brief	A single occurrence of one of several search terms in a name.
+		struct TermMatch {
+			/// @brief	The position of the search term in the MultiPattern.
+			std::uint32_t term;
+			/// @brief	The position of the name in the blob.
+			std::uint32_t index;
+			/// @brief	The offset of the occurrence from the start of the name.
+			std::uint32_t offset;
+		};
+		/**
+		 * @brief				Finds every occurrence of every search term in every name, in a single pass over the blob.
+		 *						Empty search terms match every name at offset 0.
+		 * @param patterns		The search terms to find.
+		 * @returns				Each occurrence, in no particular order.
+		 */
+		std::vector<TermMatch> find_all(MultiPattern const& patterns) const
+		{
+			std::vector<TermMatch> matches;
+			std::uint32_t index{ 0 };
+			patterns.scan(blob, [&](const std::uint32_t term, const size_t pos) {
+				// the separators never appear in a term, so occurrences can't span more than one name
+				while (offsets[index + 1] <= pos) ++index;
+				matches.emplace_back(TermMatch{ term, index, $c(std::uint32_t, pos - offsets[index]) });
+			});
+			for (std::uint32_t term{ 0 }; term < patterns.size(); ++term) {
+				if (!patterns.term(term).empty()) continue;
+				for (index = 0; index < size(); ++index)
+					matches.emplace_back(TermMatch{ term, index, 0u });
+			}
+			return matches;
+		}
+		/**
+		 * @brief					Finds every name that matches the given search term.
+		 * @param needle			The name to search for. This is not case-sensitive.
+		 * @param requireExactMatch	When true, names must be equal to needle; otherwise names must contain needle.
+		 * @returns					The positions of the matching names in ascending order.
+		 */
+		std::vector<std::uint32_t> find_names(std::string_view needle, const bool requireExactMatch) const
+		{
+			std::vector<std::uint32_t> indices;
+			if (needle.empty()) { // every name contains an empty string
+				for (std::uint32_t index{ 0 }; index < size(); ++index)
+					if (!requireExactMatch || at(index).empty())
+						indices.emplace_back(index);
+				return indices;
+			}
+			for (const auto& [index, offset] : find_all(needle)) {
+				if (!indices.empty() && indices.back() == index) continue;
+				if (!requireExactMatch || (offset == 0 && offsets[index + 1] - offsets[index] - 1 == needle.size()))
+					indices.emplace_back(index);
+			}
+			return indices;
+		}
+	};
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include <sysarch.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace alchlib2 {
+	/**
+	 * @brief		A fixed-size thread pool where each worker has its own task queue.
+	 *				Tasks are distributed round-robin; workers run their own tasks oldest-first, and idle workers
+	 *				 steal the newest task from another worker, so uneven tasks don't leave threads idle.
+	 *				The destructor finishes every submitted task before joining the workers.
+	 */
+	class WorkStealingPool {
+		using task_t = std::function<void()>;
+
+		struct Worker {
+			std::mutex mutex;
+			std::deque<task_t> tasks;
+		};
+
+		std::vector<std::unique_ptr<Worker>> workers;
+		std::vector<std::thread> threads;
+		std::mutex waitMutex;
+		std::condition_variable wake;
+		/// @brief	The number of tasks that have been submitted but not started.
+		std::atomic<size_t> pending{ 0 };
+		std::atomic<size_t> nextWorker{ 0 };
+		bool stopping{ false };
+
+		bool try_pop(const size_t self, task_t& task)
+		{
+			// run our own tasks in the order they were submitted
+			{
+				auto& own{ *workers[self] };
+				std::scoped_lock lock{ own.mutex };
+				if (!own.tasks.empty()) {
+					task = std::move(own.tasks.front());
+					own.tasks.pop_front();
+					return true;
+				}
+			}
+			// steal from the back of another worker's queue
+			for (size_t offset{ 1 }; offset < workers.size(); ++offset) {
+				auto& victim{ *workers[(self + offset) % workers.size()] };
+				std::scoped_lock lock{ victim.mutex };
+				if (!victim.tasks.empty()) {
+					task = std::move(victim.tasks.back());
+					victim.tasks.pop_back();
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void run(const size_t self)
+		{
+			for (task_t task; ; ) {
+				if (try_pop(self, task)) {
+					--pending;
+					task();
+					task = nullptr;
+					continue;
+				}
+				std::unique_lock lock{ waitMutex };
+				wake.wait(lock, [this] { return stopping || pending > 0; });
+				if (stopping && pending == 0)
+					return;
+			}
+		}
+
+	public:
+		/**
+		 * @brief				Starts the worker threads.
+		 * @param threadCount	The number of workers. 0 uses one worker per hardware thread.
+		 */
+		WorkStealingPool(unsigned threadCount = 0)
+		{
+			if (threadCount == 0)
+				threadCount = std::max(1u, std::thread::hardware_concurrency());
+			workers.reserve(threadCount);
+			for (unsigned i{ 0 }; i < threadCount; ++i)
+				workers.emplace_back(std::make_unique<Worker>());
+			threads.reserve(threadCount);
+			for (unsigned i{ 0 }; i < threadCount; ++i)
+				threads.emplace_back(&WorkStealingPool::run, this, $c(size_t, i));
+		}
+		WorkStealingPool(WorkStealingPool const&) = delete;
+		WorkStealingPool& operator=(WorkStealingPool const&) = delete;
+		~WorkStealingPool()
+		{
+			{
+				std::scoped_lock lock{ waitMutex };
+				stopping = true;
+			}
+			wake.notify_all();
+			for (auto& thread : threads)
+				thread.join();
+		}
+
+		/// @brief	Gets the number of worker threads.
+		CONSTEXPR size_t size() const noexcept { return workers.size(); }
+
+		/**
+		 * @brief		Queues a task to be run on one of the worker threads.
+		 * @param task	The task to run. It must not throw.
+		 */
+		void Submit(task_t task)
+		{
+			// count the task first so that pending never drops below the number of queued tasks
+			{
+				std::scoped_lock lock{ waitMutex };
+				++pending;
+			}
+			{
+				auto& worker{ *workers[nextWorker++ % workers.size()] };
+				std::scoped_lock lock{ worker.mutex };
+				worker.tasks.emplace_back(std::move(task));
+			}
+			wake.notify_one();
+		}
+	};
+}
@@ -1,9 +1,36 @@
 #pragma once
 #include "SerializerDefs.h"
 #include "GameSetting.hpp"
+#include "TextSearch.hpp"
 #include "Registry.hpp"
+#include "ResultSet.hpp"
+#include "RegistryIndex.hpp"
+#include "Query.hpp"
+#include "MultiSearch.hpp"
 
 #include "PerkBase.hpp"
+#include "PerkPipeline.hpp"
 
 #include "Potion.hpp"
+#include "EffectTraits.hpp"
+#include "CommonEffects.hpp"
+#include "PotionBatch.hpp"
+#include "PotionHandle.hpp"
+#include "PotionCalculator.hpp"
+#include "PotionValue.hpp"
 #include "PotionBuilder.hpp"
+#include "Fingerprint.hpp"
+#include "PotionCache.hpp"
+#include "PotionSweep.hpp"
+#include "CompatibilityMatrix.hpp"
+#include "WorkStealingPool.hpp"
+#include "RecipeEnumerator.hpp"
+#include "BoundedHeap.hpp"
+#include "ParetoFrontier.hpp"
+#include "IngredientClasses.hpp"
+#include "RecipeSolver.hpp"
+#include "SignatureIndex.hpp"
+#include "MappedFile.hpp"
+#include "RecipeDatabase.hpp"
+#include "Inventory.hpp"
+#include "BrewingPlanner.hpp"
@@ -2,12 +2,13 @@
 #include "../Effect.hpp"
 #include "../Potion.hpp"
 #include "../PerkBase.hpp"
+#include "../PerkPipeline.hpp"
 #include "../keywords/VanillaKeywords.h"
 
 #include <nlohmann/json.hpp>
 
 namespace alchlib2::perks {
-	struct AlchemistPerk : PerkBase {
+	struct AlchemistPerk final : PerkBase {
 		static constexpr const auto Name{ "Alchemist" };
 
 		/**
@@ -26,7 +27,7 @@ namespace alchlib2::perks {
 
 		NLOHMANN_DEFINE_TYPE_INTRUSIVE(AlchemistPerk, name, rank);
 	};
-	struct PhysicianPerk : PerkBase {
+	struct PhysicianPerk final : PerkBase {
 		static constexpr const auto Name{ "Physician" };
 
 		PhysicianPerk() : PerkBase(Name) {}
@@ -40,7 +41,7 @@ namespace alchlib2::perks {
 
 		NLOHMANN_DEFINE_TYPE_INTRUSIVE(PhysicianPerk, name);
 	};
-	struct BenefactorPerk : PerkBase {
+	struct BenefactorPerk final : PerkBase {
 		static constexpr const auto Name{ "Benefactor" };
 
 		/// @brief	Potions you mix with beneficial effects have an additional 25% greater magnitude.
@@ -55,7 +56,7 @@ namespace alchlib2::perks {
 
 		NLOHMANN_DEFINE_TYPE_INTRUSIVE(BenefactorPerk, name);
 	};
-	struct PoisonerPerk : PerkBase {
+	struct PoisonerPerk final : PerkBase {
 		static constexpr const auto Name{ "Poisoner" };
 
 		PoisonerPerk() : PerkBase(Name) {}
@@ -69,7 +70,7 @@ namespace alchlib2::perks {
 
 		NLOHMANN_DEFINE_TYPE_INTRUSIVE(PoisonerPerk, name);
 	};
-	struct PurityPerk : PerkBase {
+	struct PurityPerk final : PerkBase {
 		static constexpr const auto Name{ "Purity" };
 
 		PurityPerk() : PerkBase(Name) {}
@@ -109,6 +110,18 @@ namespace alchlib2::perks {
 			return perks;
 		}
 
+		/// @brief	The type of the static perk pipeline returned by GetPipeline().
+		using pipeline_t = PerkPipeline<AlchemistPerk, PhysicianPerk, BenefactorPerk, PoisonerPerk, PurityPerk>;
+
+		/**
+		 * @brief		Gets a static pipeline that applies all of the enabled perks without virtual calls or allocations.
+		 *				The pipeline refers to these perks, so it must not outlive this instance.
+		 */
+		CONSTEXPR pipeline_t GetPipeline() const noexcept
+		{
+			return{ Alchemist, Physician, Benefactor, Poisoner, Purity };
+		}
+
 		static VanillaPerks ReadFrom(std::filesystem::path const& path)
 		{
 			nlohmann::json j;
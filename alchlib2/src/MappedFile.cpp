@@ -0,0 +1,90 @@
+#include "../include/MappedFile.hpp"
+
+#include <make_exception.hpp>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace alchlib2;
+
+#ifdef _WIN32
+alchlib2::MappedFile::MappedFile(std::filesystem::path const& path)
+{
+	const auto file{ CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+	if (file == INVALID_HANDLE_VALUE)
+		throw make_exception("Failed to open ", path, "!");
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize)) {
+		CloseHandle(file);
+		throw make_exception("Failed to get the size of ", path, "!");
+	}
+	size = $c(size_t, fileSize.QuadPart);
+	if (size == 0) {
+		CloseHandle(file);
+		return;
+	}
+
+	// the view keeps the mapping alive, so both handles can be closed right away
+	const auto mapping{ CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr) };
+	CloseHandle(file);
+	if (mapping == nullptr)
+		throw make_exception("Failed to map ", path, " into memory!");
+	data = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	CloseHandle(mapping);
+	if (data == nullptr)
+		throw make_exception("Failed to map ", path, " into memory!");
+}
+
+void alchlib2::MappedFile::release() noexcept
+{
+	if (data != nullptr)
+		UnmapViewOfFile(data);
+	data = nullptr;
+	size = 0;
+}
+#else
+alchlib2::MappedFile::MappedFile(std::filesystem::path const& path)
+{
+	const auto fd{ open(path.c_str(), O_RDONLY) };
+	if (fd == -1)
+		throw make_exception("Failed to open ", path, "!");
+
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		close(fd);
+		throw make_exception("Failed to get the size of ", path, "!");
+	}
+	size = $c(size_t, info.st_size);
+	if (size == 0) {
+		close(fd);
+		return;
+	}
+
+	// the mapping keeps the file open, so the descriptor can be closed right away
+	auto* mapped{ mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0) };
+	close(fd);
+	if (mapped == MAP_FAILED) {
+		size = 0;
+		throw make_exception("Failed to map ", path, " into memory!");
+	}
+	data = static_cast<const std::byte*>(mapped);
+}
+
+void alchlib2::MappedFile::release() noexcept
+{
+	if (data != nullptr)
+		munmap(const_cast<std::byte*>(data), size);
+	data = nullptr;
+	size = 0;
+}
+#endif
@@ -0,0 +1,254 @@
+#include "../include/TextSearch.hpp"
+
+#include <make_exception.hpp>
+
+#include <atomic>
+#include <bit>
+#include <deque>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define ALCHLIB2_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define ALCHLIB2_TARGET_AVX2
+#else
+#define ALCHLIB2_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+using namespace alchlib2;
+using namespace alchlib2::text;
+
+namespace {
+	/// @brief	Compares the middle of a candidate match, ignoring case. The first & last characters were already checked.
+	inline bool verify(const char* candidate, std::string_view needle_lc) noexcept
+	{
+		for (size_t i{ 1 }; i + 1 < needle_lc.size(); ++i)
+			if (text::tolower(candidate[i]) != needle_lc[i])
+				return false;
+		return true;
+	}
+
+	/**
+	 * @brief	Scalar search kernel, also used for the tail of the vectorized kernels.
+	 *			Calls onMatch for each occurrence starting at or after pos, until it returns false.
+	 */
+	template<typename TOnMatch>
+	inline void find_scalar(std::string_view haystack, std::string_view needle_lc, size_t pos, TOnMatch const& onMatch)
+	{
+		const auto first{ needle_lc.front() }, last{ needle_lc.back() };
+		const auto k{ needle_lc.size() };
+		for (; pos + k <= haystack.size(); ++pos)
+			if (text::tolower(haystack[pos]) == first && text::tolower(haystack[pos + k - 1]) == last && verify(haystack.data() + pos, needle_lc))
+				if (!onMatch(pos)) return;
+	}
+
+#ifdef ALCHLIB2_X86
+	/*
+	 * The vectorized kernels compare the first & last characters of the needle against a block
+	 *  of candidate positions at once, then verify the remaining characters of each candidate.
+	 * Characters are folded to lowercase before comparison by adding 0x20 to bytes in 'A'..'Z';
+	 *  the signed comparison leaves non-ASCII bytes untouched, since they're all negative.
+	 */
+
+	inline __m128i fold_sse2(const __m128i v) noexcept
+	{
+		const auto isUpper{ _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1))) };
+		return _mm_add_epi8(v, _mm_and_si128(isUpper, _mm_set1_epi8(0x20)));
+	}
+
+	template<typename TOnMatch>
+	void find_sse2(std::string_view haystack, std::string_view needle_lc, TOnMatch const& onMatch)
+	{
+		const auto k{ needle_lc.size() };
+		const auto first{ _mm_set1_epi8(needle_lc.front()) }, last{ _mm_set1_epi8(needle_lc.back()) };
+		const char* data{ haystack.data() };
+
+		size_t pos{ 0 };
+		for (; pos + k - 1 + 16 <= haystack.size(); pos += 16) {
+			const auto blockFirst{ fold_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos))) };
+			const auto blockLast{ fold_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + k - 1))) };
+			auto mask{ $c(unsigned, _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last)))) };
+			while (mask != 0) {
+				const auto bit{ $c(size_t, std::countr_zero(mask)) };
+				if (verify(data + pos + bit, needle_lc) && !onMatch(pos + bit)) return;
+				mask &= mask - 1;
+			}
+		}
+		find_scalar(haystack, needle_lc, pos, onMatch);
+	}
+
+	ALCHLIB2_TARGET_AVX2 inline __m256i fold_avx2(const __m256i v) noexcept
+	{
+		const auto isUpper{ _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v)) };
+		return _mm256_add_epi8(v, _mm256_and_si256(isUpper, _mm256_set1_epi8(0x20)));
+	}
+
+	template<typename TOnMatch>
+	ALCHLIB2_TARGET_AVX2 void find_avx2(std::string_view haystack, std::string_view needle_lc, TOnMatch const& onMatch)
+	{
+		const auto k{ needle_lc.size() };
+		const auto first{ _mm256_set1_epi8(needle_lc.front()) }, last{ _mm256_set1_epi8(needle_lc.back()) };
+		const char* data{ haystack.data() };
+
+		size_t pos{ 0 };
+		for (; pos + k - 1 + 32 <= haystack.size(); pos += 32) {
+			const auto blockFirst{ fold_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos))) };
+			const auto blockLast{ fold_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos + k - 1))) };
+			auto mask{ $c(unsigned, _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last)))) };
+			while (mask != 0) {
+				const auto bit{ $c(size_t, std::countr_zero(mask)) };
+				if (verify(data + pos + bit, needle_lc) && !onMatch(pos + bit)) return;
+				mask &= mask - 1;
+			}
+		}
+		find_scalar(haystack, needle_lc, pos, onMatch);
+	}
+
+	InstructionSet detect_instruction_set() noexcept
+	{
+	#ifdef _MSC_VER
+		int info[4]{};
+		__cpuid(info, 0);
+		if (info[0] >= 7) {
+			__cpuid(info, 1);
+			const bool osxsave{ (info[2] & (1 << 27)) != 0 }, avx{ (info[2] & (1 << 28)) != 0 };
+			__cpuidex(info, 7, 0);
+			const bool avx2{ (info[1] & (1 << 5)) != 0 };
+			if (osxsave && avx && avx2 && (_xgetbv(0) & 0x6) == 0x6)
+				return InstructionSet::AVX2;
+		}
+	#else
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2"))
+			return InstructionSet::AVX2;
+	#endif
+		return InstructionSet::SSE2;
+	}
+#else
+	InstructionSet detect_instruction_set() noexcept
+	{
+		return InstructionSet::Scalar;
+	}
+#endif
+
+	const InstructionSet supportedInstructionSet{ detect_instruction_set() };
+	std::atomic<InstructionSet> activeInstructionSet{ supportedInstructionSet };
+
+	template<typename TOnMatch>
+	void dispatch(std::string_view haystack, std::string_view needle_lc, TOnMatch const& onMatch)
+	{
+		if (needle_lc.empty() || needle_lc.size() > haystack.size()) return;
+	#ifdef ALCHLIB2_X86
+		switch (activeInstructionSet.load(std::memory_order_relaxed)) {
+		case InstructionSet::AVX2:
+			find_avx2(haystack, needle_lc, onMatch);
+			return;
+		case InstructionSet::SSE2:
+			find_sse2(haystack, needle_lc, onMatch);
+			return;
+		default:
+			break;
+		}
+	#endif
+		find_scalar(haystack, needle_lc, 0, onMatch);
+	}
+}
+
+InstructionSet alchlib2::text::GetInstructionSet() noexcept
+{
+	return activeInstructionSet.load(std::memory_order_relaxed);
+}
+void alchlib2::text::SetInstructionSet(InstructionSet const& instructionSet) noexcept
+{
+	activeInstructionSet.store(($c(std::uint8_t, instructionSet) <= $c(std::uint8_t, supportedInstructionSet)) ? instructionSet : supportedInstructionSet, std::memory_order_relaxed);
+}
+
+void alchlib2::text::find_all(std::string_view haystack, std::string_view needle_lc, std::vector<size_t>& offsets)
+{
+	dispatch(haystack, needle_lc, [&offsets](const size_t pos) {
+		offsets.emplace_back(pos);
+		return true;
+	});
+}
+size_t alchlib2::text::find_first(std::string_view haystack, std::string_view needle_lc) noexcept
+{
+	if (needle_lc.empty()) return 0;
+	size_t result{ std::string_view::npos };
+	dispatch(haystack, needle_lc, [&result](const size_t pos) {
+		result = pos;
+		return false;
+	});
+	return result;
+}
+
+alchlib2::text::MultiPattern::MultiPattern(std::vector<std::string> const& terms)
+{
+	this->terms.reserve(terms.size());
+	for (const auto& term : terms)
+		this->terms.emplace_back(tolower(term));
+
+	// assign an equivalence class to each character that appears in a term, so the transition table only needs one column per class
+	for (const auto& term : this->terms) {
+		for (const auto& c : term) {
+			auto& cls{ classes[$c(std::uint8_t, c)] };
+			if (cls != 0) continue;
+			if (classCount > std::numeric_limits<std::uint8_t>::max())
+				throw make_exception("Too many unique characters in search terms!");
+			cls = $c(std::uint8_t, classCount++);
+			if (c >= 'a' && c <= 'z')
+				classes[$c(std::uint8_t, c - ('a' - 'A'))] = cls;
+		}
+	}
+
+	// build the trie; 0 means "no transition" until the failure links are resolved, since nothing can transition back to the root
+	std::vector<std::vector<std::uint32_t>> stateOutputs(1);
+	transitions.assign(classCount, 0u);
+	for (std::uint32_t i{ 0 }; i < this->terms.size(); ++i) {
+		const auto& term{ this->terms[i] };
+		if (term.empty()) continue;
+		std::uint32_t state{ 0 };
+		for (const auto& c : term) {
+			auto next{ transitions[state * classCount + classes[$c(std::uint8_t, c)]] };
+			if (next == 0) {
+				next = $c(std::uint32_t, stateOutputs.size());
+				transitions[state * classCount + classes[$c(std::uint8_t, c)]] = next;
+				stateOutputs.emplace_back();
+				transitions.resize(transitions.size() + classCount, 0u);
+			}
+			state = next;
+		}
+		stateOutputs[state].emplace_back(i);
+	}
+
+	// resolve failure links breadth-first, turning the trie into a DFA
+	std::vector<std::uint32_t> failure(stateOutputs.size(), 0u);
+	std::deque<std::uint32_t> queue;
+	for (size_t cls{ 0 }; cls < classCount; ++cls)
+		if (const auto next{ transitions[cls] }; next != 0)
+			queue.emplace_back(next);
+	while (!queue.empty()) {
+		const auto state{ queue.front() };
+		queue.pop_front();
+		const auto& fail{ failure[state] };
+		// a state's failure state is always shallower, so its outputs are already complete
+		stateOutputs[state].insert(stateOutputs[state].end(), stateOutputs[fail].begin(), stateOutputs[fail].end());
+		for (size_t cls{ 0 }; cls < classCount; ++cls) {
+			auto& next{ transitions[state * classCount + cls] };
+			if (next != 0) {
+				failure[next] = transitions[fail * classCount + cls];
+				queue.emplace_back(next);
+			}
+			else next = transitions[fail * classCount + cls];
+		}
+	}
+
+	outputOffsets.reserve(stateOutputs.size() + 1);
+	outputOffsets.emplace_back(0u);
+	for (const auto& it : stateOutputs) {
+		outputs.insert(outputs.end(), it.begin(), it.end());
+		outputOffsets.emplace_back($c(std::uint32_t, outputs.size()));
+	}
+}